@@ -1,5 +1,6 @@
 #include "Actor.h"
 #include "ActorWorld.h"
+#include "StateHash.h"
 #include <cmath>
 #include <list>
 
@@ -8,7 +9,69 @@ using namespace std;
 ///////////////////////////////////////////////////
 // Actor Implementation
 ///////////////////////////////////////////////////
-Actor::Actor(ActorWorld* world, int imageID, double startX, double startY, Direction startDir, int depth) : GraphObject(imageID, startX, startY, startDir, depth), m_world(world), m_alive(true)
+static const char* const ACTOR_TYPE_NAMES[NUM_ACTOR_TYPES] = {
+    "Socrates",
+    "RegularSalmonella",
+    "AggressiveSalmonella",
+    "EColi",
+    "HealthGoodie",
+    "FlameGoodie",
+    "LifeGoodie",
+    "Fungus",
+    "Dirt",
+    "Flame",
+    "Spray",
+    "Food",
+    "Pit",
+};
+
+const char* actorTypeName(ActorType type) {
+    return ACTOR_TYPE_NAMES[type];
+}
+
+std::size_t actorTypeSize(ActorType type) {
+    static const std::size_t ACTOR_TYPE_SIZES[NUM_ACTOR_TYPES] = {
+        sizeof(Socrates),
+        sizeof(RegularSalmonella),
+        sizeof(AggressiveSalmonella),
+        sizeof(EColi),
+        sizeof(HealthGoodie),
+        sizeof(FlameGoodie),
+        sizeof(LifeGoodie),
+        sizeof(Fungus),
+        sizeof(Dirt),
+        sizeof(Flame),
+        sizeof(Spray),
+        sizeof(Food),
+        sizeof(Pit),
+    };
+    return ACTOR_TYPE_SIZES[type];
+}
+
+int occupancyLayerOf(ActorType type) {
+    static const int OCCUPANCY_LAYERS[NUM_ACTOR_TYPES] = {
+        -1,                     // Socrates
+        OCCUPANCY_HOSTILE,
+        OCCUPANCY_HOSTILE,
+        OCCUPANCY_HOSTILE,
+        OCCUPANCY_GOODIES,
+        OCCUPANCY_GOODIES,
+        OCCUPANCY_GOODIES,
+        OCCUPANCY_HOSTILE,      // Fungus
+        OCCUPANCY_DIRT,
+        -1,                     // Flame
+        -1,                     // Spray
+        OCCUPANCY_FOOD,
+        -1,                     // Pit
+    };
+    return OCCUPANCY_LAYERS[type];
+}
+
+bool actorTypeActs(ActorType type) {
+    return type != ACTOR_DIRT && type != ACTOR_FOOD;
+}
+
+Actor::Actor(ActorWorld* world, int imageID, double startX, double startY, Direction startDir, int depth) : GraphObject(imageID, startX, startY, startDir, depth), m_world(world), m_alive(true), m_occupancyCell(-1), m_id(0), m_hashedState(0), m_rehashSlot(-1)
 {}
 
     // Identifiers
@@ -56,6 +119,7 @@ bool Actor::isAlive() const {
     // Mutators
 void Actor::setDead() {
     m_alive = false;
+    m_world->actorStateChanged(this);
 }
 
 
@@ -91,6 +155,65 @@ int Actor::distanceFromCentre(double x, double y) {
     return sqrt(pow(x, 2) + pow(y, 2));
 }
 
+void Actor::moveTo(double x, double y) {
+    GraphObject::moveTo(x, y);
+    
+        // Most moves stay within a cell
+    if (m_occupancyCell >= 0) {
+        int cell = OccupancyGrid::cellOf(x, y);
+        if (cell != m_occupancyCell)
+            m_world->actorChangedCell(this, cell);
+    }
+}
+
+int Actor::occupancyCell() const {
+    return m_occupancyCell;
+}
+
+void Actor::setOccupancyCell(int cell) {
+    m_occupancyCell = cell;
+}
+
+    // State Hashing
+unsigned int Actor::getId() const {
+    return m_id;
+}
+
+void Actor::setId(unsigned int id) {
+    m_id = id;
+}
+
+uint64_t Actor::stateHash() const {
+    StateHasher h;
+    hashState(h);
+    return h.value();
+}
+
+uint64_t Actor::hashedState() const {
+    return m_hashedState;
+}
+
+void Actor::setHashedState(uint64_t hash) {
+    m_hashedState = hash;
+}
+
+int Actor::rehashSlot() const {
+    return m_rehashSlot;
+}
+
+void Actor::setRehashSlot(int slot) {
+    m_rehashSlot = slot;
+}
+
+void Actor::hashState(StateHasher& h) const {
+    h.add(m_id);
+    h.add(static_cast<int>(getType()));
+    h.add(getX());
+    h.add(getY());
+    h.add(getDirection());
+    h.add(m_alive);
+}
+
 /////////////////////////////////////////////////////////////
 // Damageable Implementation
 /////////////////////////////////////////////////////////////
@@ -118,12 +241,18 @@ int Character::getHealth() const {
     return m_health;
 }
 
+void Character::hashState(StateHasher& h) const {
+    Damageable::hashState(h);
+    h.add(m_health);
+}
+
     // Mutators
 void Character::damageCharacter(int dmg) {
     if (dmg < 0)
         return;
     
     m_health -= dmg;
+    getWorld()->actorStateChanged(this);
     
     if (m_health <= 0)
         setDead();
@@ -132,21 +261,26 @@ void Character::damageCharacter(int dmg) {
     // Protected Mutators
 void Character::setHealth(int hp) {
     m_health = hp;
+    getWorld()->actorStateChanged(this);
 }
 
 /////////////////////////////////////////////////////////
 // Socrates Implementation
 /////////////////////////////////////////////////////////
-Socrates::Socrates(ActorWorld* world) : Character(world, IID_PLAYER, 0, VIEW_HEIGHT/2, 100), m_sprayCharges(20), m_flameCharges(5)
+Socrates::Socrates(ActorWorld* world) : Character(world, IID_PLAYER, 0, VIEW_HEIGHT/2, 100), m_sprayCharges(20), m_flameCharges(5), m_sprayCanRecharge(true)
 {}
 
+ActorType Socrates::getType() const {
+    return ACTOR_SOCRATES;
+}
+
     // Socrates will do something every tick - move, spray/flame, or recharge his sprays
 void Socrates::doSomething() {
     if (!isAlive())
         return;
     
     int kp;
-    if (getWorld()->getKey(kp)) {
+    if (getWorld()->playerKey(kp)) {
         switch (kp) {
             case KEY_PRESS_LEFT: {
                 moveAngle(getDirection(), VIEW_WIDTH/2);        // move to centre
@@ -194,6 +328,13 @@ int Socrates::flamesRemaining() const {
     return m_flameCharges;
 }
 
+void Socrates::hashState(StateHasher& h) const {
+    Character::hashState(h);
+    h.add(m_sprayCharges);
+    h.add(m_flameCharges);
+    h.add(m_sprayCanRecharge);
+}
+
     // Mutators
 void Socrates::damageCharacter(int dmg) {
     Character::damageCharacter(dmg);
@@ -256,9 +397,9 @@ void Bacteria::setDead() {
     Actor::setDead();
     
     // Update the ActorWorld
-    getWorld()->increaseScore(100);
-    getWorld()->dropFood(getX(), getY());
-    getWorld()->decBacteriaCount();
+    getWorld()->postEvent(EVENT_SCORE, 100);
+    getWorld()->postEvent(EVENT_DROP_FOOD, 0, getX(), getY());
+    getWorld()->postEvent(EVENT_BACTERIUM_DIED);
 }
 
     // Protected Accessors
@@ -270,6 +411,12 @@ int Bacteria::getMovementPlanDist() const {
     return m_movementPlanDist;
 }
 
+void Bacteria::hashState(StateHasher& h) const {
+    Character::hashState(h);
+    h.add(m_movementPlanDist);
+    h.add(m_foodEaten);
+}
+
     // Protected Mutators
 void Bacteria::incFoodEaten() {
     m_foodEaten++;
@@ -432,6 +579,10 @@ void Salmonella::selectNewDir() {
 RegularSalmonella::RegularSalmonella(ActorWorld* world, double startX, double startY) : Salmonella(world, startX, startY, 4, 1)
 {}
 
+ActorType RegularSalmonella::getType() const {
+    return ACTOR_REGULAR_SALMONELLA;
+}
+
     // Protected Auxiliary Functions
 void RegularSalmonella::divide(double& spawnX, double& spawnY) {
     Bacteria::divide(spawnX, spawnY);
@@ -449,6 +600,10 @@ bool RegularSalmonella::aggressivePathfind() {
 AggressiveSalmonella::AggressiveSalmonella(ActorWorld* world, double startX, double startY) : Salmonella(world, startX, startY, 10, 2)
 {}
 
+ActorType AggressiveSalmonella::getType() const {
+    return ACTOR_AGGRESSIVE_SALMONELLA;
+}
+
     // Protected Auxiliary Functions
 void AggressiveSalmonella::divide(double& spawnX, double& spawnY) {
     Bacteria::divide(spawnX, spawnY);
@@ -476,6 +631,10 @@ bool AggressiveSalmonella::aggressivePathfind() {
 EColi::EColi(ActorWorld* world, double startX, double startY) : Bacteria(world, IID_ECOLI, startX, startY, 10, 4)
 {}
 
+ActorType EColi::getType() const {
+    return ACTOR_ECOLI;
+}
+
 void EColi::specificBacteriaAction() {
     attemptToDamageSocrates();
     
@@ -531,7 +690,7 @@ void Goodie::doSomething() {
 
 void Goodie::specificGoodieAction() {
     getWorld()->playSound(SOUND_GOT_GOODIE);
-    getWorld()->increaseScore(getScoreValue());
+    getWorld()->postEvent(EVENT_SCORE, getScoreValue());
 }
 
     // Identifier
@@ -552,6 +711,11 @@ int Goodie::getScoreValue() const {
     return m_scoreValue;
 }
 
+void Goodie::hashState(StateHasher& h) const {
+    Damageable::hashState(h);
+    h.add(m_timeRemaining);
+}
+
 ///////////////////////////////////////////////////////////////////////
 // HealthGoodie Implementation
 ///////////////////////////////////////////////////////////////////////
@@ -559,9 +723,13 @@ HealthGoodie::HealthGoodie(ActorWorld* world, double startX, double startY)
     : Goodie(world, IID_RESTORE_HEALTH_GOODIE, startX, startY, max(randInt(0, 300 - 10 * world->getLevel() -1), 50), 250)
 {}
 
+ActorType HealthGoodie::getType() const {
+    return ACTOR_HEALTH_GOODIE;
+}
+
 void HealthGoodie::specificGoodieAction() {
     Goodie::specificGoodieAction();
-    getWorld()->healSocrates();
+    getWorld()->postEvent(EVENT_HEAL_SOCRATES);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -571,9 +739,13 @@ FlameGoodie::FlameGoodie(ActorWorld* world, double startX, double startY)
     : Goodie(world, IID_FLAME_THROWER_GOODIE, startX, startY, max(randInt(0, 300 - 10 * world->getLevel() - 1), 50), 300)
 {}
 
+ActorType FlameGoodie::getType() const {
+    return ACTOR_FLAME_GOODIE;
+}
+
 void FlameGoodie::specificGoodieAction() {
     Goodie::specificGoodieAction();
-    getWorld()->rechargeFlamethrower();
+    getWorld()->postEvent(EVENT_RECHARGE_FLAMETHROWER);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -583,9 +755,13 @@ LifeGoodie::LifeGoodie(ActorWorld* world, double startX, double startY)
     : Goodie(world, IID_EXTRA_LIFE_GOODIE, startX, startY, max(randInt(0, 300 - 10 * world->getLevel() - 1), 50), 500)
 {}
 
+ActorType LifeGoodie::getType() const {
+    return ACTOR_LIFE_GOODIE;
+}
+
 void LifeGoodie::specificGoodieAction() {
     Goodie::specificGoodieAction();
-    getWorld()->incLives();
+    getWorld()->postEvent(EVENT_EXTRA_LIFE);
 }
 
 /////////////////////////////////////////////////////////
@@ -595,9 +771,13 @@ Fungus::Fungus(ActorWorld* world, double startX, double startY)
     : Goodie(world, IID_FUNGUS, startX, startY, max(randInt(0, 300 - 10 * world->getLevel() - 1), 50), -50)
 {}
 
+ActorType Fungus::getType() const {
+    return ACTOR_FUNGUS;
+}
+
 void Fungus::specificGoodieAction() {
-    getWorld()->increaseScore(getScoreValue());
-    getWorld()->fungusHurtSocrates();
+    getWorld()->postEvent(EVENT_SCORE, getScoreValue());
+    getWorld()->postEvent(EVENT_HURT_SOCRATES, 20);
 }
 
 /////////////////////////////////////////////////////////
@@ -605,6 +785,10 @@ void Fungus::specificGoodieAction() {
 /////////////////////////////////////////////////////////
 Dirt::Dirt(ActorWorld* world, double startX, double startY) : Damageable(world, IID_DIRT, startX, startY)
 {}
+
+ActorType Dirt::getType() const {
+    return ACTOR_DIRT;
+}
     
     // Dirt does nothing every tick - just return
 void Dirt::doSomething() {
@@ -659,12 +843,21 @@ void Projectile::travelDistance(int dist) {
         setDead();
 }
 
+void Projectile::hashState(StateHasher& h) const {
+    Actor::hashState(h);
+    h.add(m_distanceTravelled);
+}
+
 /////////////////////////////////////////////////////////
 // Flame Implementation
 /////////////////////////////////////////////////////////
 Flame::Flame(ActorWorld* world, double startX, double startY, Direction startDir) : Projectile(world, IID_FLAME, startX, startY, startDir, 32, 5)
 {}
 
+ActorType Flame::getType() const {
+    return ACTOR_FLAME;
+}
+
 void Flame::specificProjectileAction() {
     getWorld()->flameDamage(this);
 }
@@ -675,6 +868,10 @@ void Flame::specificProjectileAction() {
 Spray::Spray(ActorWorld* world, double startX, double startY, Direction startDir) : Projectile(world, IID_SPRAY, startX, startY, startDir, 112, 2)
 {}
 
+ActorType Spray::getType() const {
+    return ACTOR_SPRAY;
+}
+
 void Spray::specificProjectileAction() {
     getWorld()->sprayDamage(this);
 }
@@ -685,6 +882,10 @@ void Spray::specificProjectileAction() {
 Food::Food(ActorWorld* world, double startX, double startY) : Actor(world, IID_FOOD, startX, startY, up, 1)
 {}
 
+ActorType Food::getType() const {
+    return ACTOR_FOOD;
+}
+
     // Food does nothing every tick
 void Food::doSomething() {
     return;
@@ -705,6 +906,10 @@ Pit::Pit(ActorWorld* world, double startX, double startY) : Actor(world, IID_PIT
 //    m_bacteriaInv[2] = 2;  // element 2 represents EColi yet to spawn
 }
 
+ActorType Pit::getType() const {
+    return ACTOR_PIT;
+}
+
     // Pits have a chance to spawn Bacteria every tick
 void Pit::doSomething() {
     if (!isAlive())
@@ -749,7 +954,7 @@ bool Pit::isBacteriaSpawner() const {
     // Mutator
 void Pit::setDead() {
     Actor::setDead();
-    getWorld()->decPitCount();
+    getWorld()->postEvent(EVENT_PIT_EMPTIED);
 }
 
     // Private Auxiliary Functions
@@ -757,6 +962,13 @@ bool Pit::isPitEmpty() const {
     return m_regSalLeft == 0 && m_aggSalLeft == 0 && m_eColiLeft == 0;
 }
 
+void Pit::hashState(StateHasher& h) const {
+    Actor::hashState(h);
+    h.add(m_regSalLeft);
+    h.add(m_aggSalLeft);
+    h.add(m_eColiLeft);
+}
+
 int Pit::spawnWhichBacteria() const {
     if (m_regSalLeft == 0 && m_aggSalLeft == 0) {
         return 2;
@@ -2,9 +2,35 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "OccupancyGrid.h"
+#include <cstdint>
 
 // Forward declaration of ActorWorld
 class ActorWorld;
+class StateHasher;
+
+    // Every concrete kind of Actor, for code that needs to tell them apart cheaply (profiling, accounting)
+enum ActorType {
+    ACTOR_SOCRATES,
+    ACTOR_REGULAR_SALMONELLA,
+    ACTOR_AGGRESSIVE_SALMONELLA,
+    ACTOR_ECOLI,
+    ACTOR_HEALTH_GOODIE,
+    ACTOR_FLAME_GOODIE,
+    ACTOR_LIFE_GOODIE,
+    ACTOR_FUNGUS,
+    ACTOR_DIRT,
+    ACTOR_FLAME,
+    ACTOR_SPRAY,
+    ACTOR_FOOD,
+    ACTOR_PIT,
+    NUM_ACTOR_TYPES
+};
+
+const char* actorTypeName(ActorType type);
+std::size_t actorTypeSize(ActorType type);     // sizeof the concrete class
+int occupancyLayerOf(ActorType type);           // an OccupancyLayer, or -1 if not on any
+bool actorTypeActs(ActorType type);             // false if its doSomething does nothing
 
 ///////////////////////////////////////////
 // Actor Definition
@@ -26,6 +52,9 @@ public:
     virtual bool isEdible() const;
     virtual bool isBacteriaSpawner() const;
     
+        // Concrete type
+    virtual ActorType getType() const = 0;
+    
         // Accessors
     ActorWorld* getWorld() const;
     bool isAlive() const;
@@ -40,9 +69,35 @@ public:
     int distance(double x1, double y1, Actor* a) const;
     int distanceFromCentre(double x, double y);
     
+        // Moving also moves the actor on its world's occupancy grid
+    virtual void moveTo(double x, double y);
+    int occupancyCell() const;          // -1 if it isn't counted on the grid
+    void setOccupancyCell(int cell);
+    
+        // Identity and state, for checking that two runs play out exactly the same
+    unsigned int getId() const;         // given by the world, in the order actors join it; 0 before
+    void setId(unsigned int id);
+    std::uint64_t stateHash() const;
+    
+        // For the world's running state hash: what this actor last added to
+        // it, and its place on the world's list of actors to rehash (-1 if
+        // it isn't on it)
+    std::uint64_t hashedState() const;
+    void setHashedState(std::uint64_t hash);
+    int rehashSlot() const;
+    void setRehashSlot(int slot);
+    
+protected:
+        // Each class adds its own state to what its base class hashes
+    virtual void hashState(StateHasher& h) const;
+    
 private:
     ActorWorld* m_world;
     bool m_alive;
+    int m_occupancyCell;
+    unsigned int m_id;
+    std::uint64_t m_hashedState;
+    int m_rehashSlot;
 };
     // Damageable, Projectile, Food and Pit inherit from this
 
@@ -79,6 +134,7 @@ public:
 protected:
         // Protected Mutator
     void setHealth(int hp);
+    virtual void hashState(StateHasher& h) const;
 private:
     int m_health;
 };
@@ -91,6 +147,7 @@ private:
 class Socrates : public Character {
 public:
     Socrates(ActorWorld* world);
+    virtual ActorType getType() const;
         // Socrates must do something every tick
     virtual void doSomething();
     
@@ -107,6 +164,9 @@ public:
     void sprayDisinfectant();
     void throwFlames();
     
+protected:
+    virtual void hashState(StateHasher& h) const;
+    
 private:
     int m_sprayCharges;
     int m_flameCharges;
@@ -152,6 +212,7 @@ protected:
     Direction findDirectionTo(const double& targetX, const double& targetY);
     void divideOrEat();
     void attemptToDamageSocrates();
+    virtual void hashState(StateHasher& h) const;
 
     
 private:
@@ -194,6 +255,7 @@ protected:
 class RegularSalmonella : public Salmonella {
 public:
     RegularSalmonella(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     
 protected:
         // Protected Auxiliary Functions
@@ -207,6 +269,7 @@ protected:
 class AggressiveSalmonella : public Salmonella {
 public:
     AggressiveSalmonella(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     
 protected:
         // Protected Auxiliary Functions
@@ -220,6 +283,7 @@ protected:
 class EColi : public Bacteria {
 public:
     EColi(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
         // EColi take a specific action every tick
     virtual void specificBacteriaAction();
     
@@ -254,6 +318,8 @@ protected:
         // Protected Accessors
     int getScoreValue() const;
     
+    virtual void hashState(StateHasher& h) const;
+    
 private:
     int m_timeRemaining;
     int m_scoreValue;
@@ -267,6 +333,7 @@ private:
 class HealthGoodie : public Goodie {
 public:
     HealthGoodie(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     virtual void specificGoodieAction();
 };
 
@@ -277,6 +344,7 @@ public:
 class FlameGoodie : public Goodie {
 public:
     FlameGoodie(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     virtual void specificGoodieAction();
 };
 
@@ -287,6 +355,7 @@ public:
 class LifeGoodie : public Goodie {
 public:
     LifeGoodie(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     virtual void specificGoodieAction();
 };
 
@@ -297,6 +366,7 @@ public:
 class Fungus : public Goodie {
 public:
     Fungus(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
     virtual void specificGoodieAction();
 };
 
@@ -307,6 +377,7 @@ public:
 class Dirt : public Damageable {
 public:
     Dirt(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
         // Dirt must do something every tick
     virtual void doSomething();
         // Identifier
@@ -339,6 +410,8 @@ protected:
         // Protected Mutators
     void travelDistance(int dist);
     
+    virtual void hashState(StateHasher& h) const;
+    
 private:
     int m_maxTravelDistance;
     int m_distanceTravelled;
@@ -353,6 +426,7 @@ private:
 class Flame : public Projectile {
 public:
     Flame(ActorWorld* world, double startX, double startY, Direction startDir);
+    virtual ActorType getType() const;
     virtual void specificProjectileAction();
 };
 
@@ -363,6 +437,7 @@ public:
 class Spray : public Projectile {
 public:
     Spray(ActorWorld* world, double startX, double startY, Direction startDir);
+    virtual ActorType getType() const;
     virtual void specificProjectileAction();
 };
 
@@ -373,6 +448,7 @@ public:
 class Food : public Actor {
 public:
     Food(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
         // Food must do something every tick
     virtual void doSomething();
         // Identifier
@@ -386,6 +462,7 @@ public:
 class Pit : public Actor {
 public:
     Pit(ActorWorld* world, double startX, double startY);
+    virtual ActorType getType() const;
         // Pits must do something every tick
     virtual void doSomething();
     
@@ -394,6 +471,9 @@ public:
         // Mutator
     virtual void setDead();
     
+protected:
+    virtual void hashState(StateHasher& h) const;
+    
 private:
     int m_regSalLeft;
     int m_aggSalLeft;
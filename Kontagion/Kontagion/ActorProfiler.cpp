@@ -0,0 +1,84 @@
+#include "ActorProfiler.h"
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+static const char* const QUERY_NAMES[NUM_ACTOR_QUERIES] = {
+    "bacteriaMovementBlocked", "canEatFood", "findFood", "flameDamage", "sprayDamage"
+};
+
+ActorProfiler::ActorProfiler()
+{
+    reset();
+}
+
+ActorProfiler& ActorProfiler::current()
+{
+    static thread_local ActorProfiler profiler;
+    return profiler;
+}
+
+void ActorProfiler::recordUpdate(ActorType type, long long ns)
+{
+    TypeStats& stats = m_types[type];
+    stats.updates++;
+    stats.totalNs += ns;
+    stats.maxNs = max(stats.maxNs, ns);
+}
+
+void ActorProfiler::recordQuery(ActorQuery query, unsigned long long visits)
+{
+    QueryStats& stats = m_queries[query];
+    stats.calls++;
+    stats.visits += visits;
+    stats.maxVisits = max(stats.maxVisits, visits);
+    if (m_updating != NUM_ACTOR_TYPES)
+        m_types[m_updating].queryVisits += visits;
+}
+
+bool ActorProfiler::empty() const
+{
+    for (const TypeStats& t : m_types)
+        if (t.updates != 0)
+            return false;
+    return true;
+}
+
+void ActorProfiler::reset()
+{
+    for (TypeStats& t : m_types)
+        t = TypeStats();
+    for (QueryStats& q : m_queries)
+        q = QueryStats();
+    m_updating = NUM_ACTOR_TYPES;   // nobody
+}
+
+void ActorProfiler::print(ostream& out) const
+{
+    streamsize precision = out.precision();
+    out << left << setw(22) << "actor type" << right << setw(10) << "updates" << setw(12) << "total us"
+        << setw(10) << "mean ns" << setw(10) << "max ns" << setw(14) << "query visits" << endl;
+    for (int i = 0; i < NUM_ACTOR_TYPES; i++)
+    {
+        const TypeStats& t = m_types[i];
+        if (t.updates == 0)
+            continue;
+        out << left << setw(22) << actorTypeName(static_cast<ActorType>(i)) << right << setw(10) << t.updates
+            << setw(12) << t.totalNs / 1000 << setw(10) << t.totalNs / static_cast<long long>(t.updates)
+            << setw(10) << t.maxNs << setw(14) << t.queryVisits << endl;
+    }
+
+    out << left << setw(24) << "query" << right << setw(10) << "calls" << setw(12) << "visits"
+        << setw(12) << "mean" << setw(10) << "max" << endl;
+    for (int i = 0; i < NUM_ACTOR_QUERIES; i++)
+    {
+        const QueryStats& q = m_queries[i];
+        if (q.calls == 0)
+            continue;
+        out << left << setw(24) << QUERY_NAMES[i] << right << setw(10) << q.calls << setw(12) << q.visits
+            << setw(12) << fixed << setprecision(1) << static_cast<double>(q.visits) / q.calls
+            << setw(10) << q.maxVisits << endl;
+        out.unsetf(ios::fixed);
+    }
+    out.precision(precision);
+}
@@ -0,0 +1,135 @@
+#ifndef ACTORPROFILER_H_
+#define ACTORPROFILER_H_
+
+#include "Actor.h"
+#include <chrono>
+#include <ostream>
+
+  // Per-actor-type tick profiling.  Build with -DKONTAGION_PROFILE_ACTORS to
+  // time every doSomething call by concrete actor type and count how many
+  // actors each world query looks at; without it the macros below compile
+  // to nothing.  The totals are printed when a level ends, or when the
+  // player presses 'p'.
+
+enum ActorQuery
+{
+    QUERY_MOVEMENT_BLOCKED,
+    QUERY_CAN_EAT_FOOD,
+    QUERY_FIND_FOOD,
+    QUERY_FLAME_DAMAGE,
+    QUERY_SPRAY_DAMAGE,
+    NUM_ACTOR_QUERIES
+};
+
+class ActorProfiler
+{
+  public:
+    struct TypeStats
+    {
+        unsigned long long updates;
+        long long          totalNs;
+        long long          maxNs;
+        unsigned long long queryVisits;     // actors visited by queries it made
+    };
+
+    struct QueryStats
+    {
+        unsigned long long calls;
+        unsigned long long visits;
+        unsigned long long maxVisits;
+    };
+
+    ActorProfiler();
+
+      // The profiler for the calling thread's world
+    static ActorProfiler& current();
+
+    void recordUpdate(ActorType type, long long ns);
+    void recordQuery(ActorQuery query, unsigned long long visits);
+
+    ActorType updating() const
+    {
+        return m_updating;
+    }
+    void setUpdating(ActorType type)
+    {
+        m_updating = type;
+    }
+
+    bool empty() const;
+    void reset();
+    void print(std::ostream& out) const;
+
+  private:
+    TypeStats  m_types[NUM_ACTOR_TYPES];
+    QueryStats m_queries[NUM_ACTOR_QUERIES];
+    ActorType  m_updating;
+};
+
+  // Times one doSomething call and makes queries it makes count against
+  // the actor's type
+class ActorUpdateTimer
+{
+  public:
+    ActorUpdateTimer(const Actor* actor)
+     : m_type(actor->getType()), m_outer(ActorProfiler::current().updating()),
+       m_start(std::chrono::steady_clock::now())
+    {
+        ActorProfiler::current().setUpdating(m_type);
+    }
+
+    ~ActorUpdateTimer()
+    {
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - m_start;
+        ActorProfiler::current().recordUpdate(m_type, elapsed.count());
+        ActorProfiler::current().setUpdating(m_outer);
+    }
+
+  private:
+    ActorType m_type;
+    ActorType m_outer;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+  // Counts the actors one query looks at
+class ActorQueryCounter
+{
+  public:
+    ActorQueryCounter(ActorQuery query)
+     : m_query(query), m_visits(0)
+    {
+    }
+
+    ~ActorQueryCounter()
+    {
+        ActorProfiler::current().recordQuery(m_query, m_visits);
+    }
+
+    void visit()
+    {
+        m_visits++;
+    }
+
+  private:
+    ActorQuery         m_query;
+    unsigned long long m_visits;
+};
+
+#ifdef KONTAGION_PROFILE_ACTORS
+
+#define PROFILE_ACTOR_UPDATE(actor)  ActorUpdateTimer profileActorUpdate_(actor)
+#define PROFILE_QUERY(query)         ActorQueryCounter profileQuery_(query)
+#define PROFILE_QUERY_VISIT()        profileQuery_.visit()
+#define PROFILE_ACTORS_DUMP(out)     do { ActorProfiler& p_ = ActorProfiler::current(); \
+                                          if (!p_.empty()) { p_.print(out); p_.reset(); } } while (0)
+
+#else
+
+#define PROFILE_ACTOR_UPDATE(actor)  ((void)0)
+#define PROFILE_QUERY(query)         ((void)0)
+#define PROFILE_QUERY_VISIT()        ((void)0)
+#define PROFILE_ACTORS_DUMP(out)     ((void)0)
+
+#endif // KONTAGION_PROFILE_ACTORS
+
+#endif // ACTORPROFILER_H_
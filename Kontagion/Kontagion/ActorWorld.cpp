@@ -1,11 +1,17 @@
 #include "ActorWorld.h"
 #include "GameConstants.h"
 #include "Actor.h"
+#include "ActorProfiler.h"
+#include "Tracer.h"
+#include "InputPolicy.h"
+#include "Replay.h"
+#include "StateHash.h"
 
 #include <string>
+#include <iostream>
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <charconv>
+#include <cstring>
 #include <cmath>
 using namespace std;
 
@@ -14,11 +20,89 @@ GameWorld* createActorWorld(string assetPath)
 	return new ActorWorld(assetPath);
 }
 
-ActorWorld::ActorWorld(string assetPath) : GameWorld(assetPath), socrates(nullptr), m_bacteria(0), m_pits(0)
+ActorWorld::ActorWorld(string assetPath) : GameWorld(assetPath), socrates(nullptr), m_bacteria(0), m_pits(0), m_shownStatus(), m_eventCount(0), m_subscriberCount(0), m_population(), m_memoryReport(&cout), m_inputPolicy(nullptr), m_recorder(nullptr), m_ticks(0), m_nextActorId(1), m_hashing(false), m_actorsHash(0)
 {}
 
 ActorWorld::~ActorWorld() {
+    if (m_recorder != nullptr)
+        m_recorder->finish(m_ticks, getScore(), getLevel(), getLives());
     cleanUp();
+    if (m_memoryReport != nullptr)
+        m_memory.reportRun(*m_memoryReport);
+}
+
+/////////////////////////////////////////////////////////////////
+// World Events
+/////////////////////////////////////////////////////////////////
+void ActorWorld::postEvent(WorldEventType type, int amount, double x, double y) {
+        // If a tick somehow produces more events than fit, apply what we have
+        // early rather than lose any
+    if (m_eventCount == MAX_WORLD_EVENTS)
+        drainEvents();
+    
+    WorldEvent& event = m_events[m_eventCount++];
+    event.type = type;
+    event.amount = amount;
+    event.x = x;
+    event.y = y;
+}
+
+bool ActorWorld::subscribe(WorldEventListener listener, void* context) {
+    if (m_subscriberCount == MAX_WORLD_EVENT_LISTENERS)
+        return false;
+    m_subscribers[m_subscriberCount].listener = listener;
+    m_subscribers[m_subscriberCount].context = context;
+    m_subscriberCount++;
+    return true;
+}
+
+void ActorWorld::unsubscribe(WorldEventListener listener, void* context) {
+    for (int i = 0; i < m_subscriberCount; i++) {
+        if (m_subscribers[i].listener == listener && m_subscribers[i].context == context) {
+            m_subscribers[i] = m_subscribers[--m_subscriberCount];
+            return;
+        }
+    }
+}
+
+int ActorWorld::drainEvents() {
+    int drained = m_eventCount;
+    for (int i = 0; i < m_eventCount; i++) {
+        applyEvent(m_events[i]);
+        for (int s = 0; s < m_subscriberCount; s++)
+            m_subscribers[s].listener(m_events[i], m_subscribers[s].context);
+    }
+    m_eventCount = 0;
+    return drained;
+}
+
+void ActorWorld::applyEvent(const WorldEvent& event) {
+    switch (event.type) {
+        case EVENT_SCORE:
+            increaseScore(event.amount);
+            break;
+        case EVENT_DROP_FOOD:
+            dropFood(event.x, event.y);
+            break;
+        case EVENT_BACTERIUM_DIED:
+            decBacteriaCount();
+            break;
+        case EVENT_PIT_EMPTIED:
+            decPitCount();
+            break;
+        case EVENT_HEAL_SOCRATES:
+            healSocrates();
+            break;
+        case EVENT_HURT_SOCRATES:
+            fungusHurtSocrates(event.amount);
+            break;
+        case EVENT_RECHARGE_FLAMETHROWER:
+            rechargeFlamethrower();
+            break;
+        case EVENT_EXTRA_LIFE:
+            incLives();
+            break;
+    }
 }
 
 /////////////////////////////////////////////////////////////////
@@ -43,6 +127,25 @@ bool ActorWorld::socratesOverlap(Actor* a) {
     return a->overlaps(a, socrates);
 }
 
+void ActorWorld::setInputPolicy(InputPolicy* policy) {
+    m_inputPolicy = policy;
+}
+
+bool ActorWorld::playerKey(int& key) {
+    bool pressed = (m_inputPolicy != nullptr ? m_inputPolicy->nextKey(*this, key) : getKey(key));
+    if (pressed  &&  m_recorder != nullptr)
+        m_recorder->record(m_ticks, key);
+    return pressed;
+}
+
+void ActorWorld::recordInputTo(ReplayRecorder* recorder) {
+    m_recorder = recorder;
+}
+
+long long ActorWorld::ticks() const {
+    return m_ticks;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Bacteria Auxiliary Functions
 //////////////////////////////////////////////////////////////////////
@@ -56,7 +159,9 @@ bool ActorWorld::bacteriaSocratesOverlap(Bacteria* bacteria) {
 }
 
 bool ActorWorld::bacteriaMovementBlocked(const double& attemptX, const double& attemptY) const {
+    PROFILE_QUERY(QUERY_MOVEMENT_BLOCKED);
     for (auto itr = actors.begin(); itr != actors.end(); ) {
+        PROFILE_QUERY_VISIT();
         if ((*itr)->isAlive() && (*itr)->isBlocker() && (*itr)->movementOverlap(attemptX, attemptY, *itr)) {
             return true;
         }
@@ -77,7 +182,9 @@ bool ActorWorld::nearSocrates(Bacteria* bacteria, double& socratesX, double& soc
 }
 
 bool ActorWorld::canEatFood(Bacteria* bacteria) {
+    PROFILE_QUERY(QUERY_CAN_EAT_FOOD);
     for (auto itr = actors.begin(); itr != actors.end(); ) {
+        PROFILE_QUERY_VISIT();
         if ((*itr)->isAlive() && (*itr)->isEdible() && bacteria->overlaps(bacteria, *itr)) {
             (*itr)->setDead();
             return true;        // the Bacteria will then eat the Food in this function's caller
@@ -93,7 +200,9 @@ bool ActorWorld::canEatFood(Bacteria* bacteria) {
 bool ActorWorld::findFood(Bacteria* bacteria, double& foodX, double& foodY) {
     int minDistToFood = 129;    // Food must be within 128 pixels of the Bacteria for it to pathfind to the food
     Actor* nearestFood = nullptr;
+    PROFILE_QUERY(QUERY_FIND_FOOD);
     for (auto itr = actors.begin(); itr != actors.end(); itr++) {
+        PROFILE_QUERY_VISIT();
         if ((*itr)->isAlive() && (*itr)->isEdible() && bacteria->distance(bacteria, *itr) <= 128) {
             if (minDistToFood > bacteria->distance(bacteria, *itr)) {
                 minDistToFood = bacteria->distance(bacteria, *itr);
@@ -115,24 +224,24 @@ bool ActorWorld::findFood(Bacteria* bacteria, double& foodX, double& foodY) {
 void ActorWorld::dropFood(double x, double y) {
     int chance = randInt(0, 1);
     if (chance == 1)
-        actors.push_back(new Food(this, x, y));
+        addActor(new Food(this, x, y));
 }
 
 /////////////////////////////////////////////////////////////////
 // Bacteria Spawning Functions
 /////////////////////////////////////////////////////////////////
 void ActorWorld::spawnRegSal(double startX, double startY) {
-    actors.push_back(new RegularSalmonella(this, startX, startY));
+    addActor(new RegularSalmonella(this, startX, startY));
     m_bacteria++;
 }
 
 void ActorWorld::spawnAggSal(double startX, double startY) {
-    actors.push_back(new AggressiveSalmonella(this, startX, startY));
+    addActor(new AggressiveSalmonella(this, startX, startY));
     m_bacteria++;
 }
 
 void ActorWorld::spawnEColi(double startX, double startY) {
-    actors.push_back(new EColi(this, startX, startY));
+    addActor(new EColi(this, startX, startY));
     m_bacteria++;
 }
 
@@ -143,12 +252,14 @@ void ActorWorld::throwFlames() {
     for (int i = 0; i < 16; i++) {
         double flameX, flameY;
         socrates->getPositionInThisDirection(i*22, SPRITE_WIDTH, flameX, flameY);
-        actors.push_front(new Flame(this, flameX, flameY, i*22));
+        addProjectile(new Flame(this, flameX, flameY, i*22));
     }
 }
 
 void ActorWorld::flameDamage(Projectile* flame) {
+    PROFILE_QUERY(QUERY_FLAME_DAMAGE);
     for (auto itr = actors.begin(); itr != actors.end(); ) {
+        PROFILE_QUERY_VISIT();
         if ((*itr)->isAlive() && (*itr)->isDamageable() && flame->overlaps(flame, *itr)) {
             if ((*itr)->isCharacter()) {
                 Character* theCharacter = static_cast<Character*>(*itr); // *itr is guaranteed to be a Character
@@ -171,11 +282,13 @@ void ActorWorld::flameDamage(Projectile* flame) {
 void ActorWorld::sprayDisinfectant() {
     double sprayX, sprayY;
     socrates->getPositionInThisDirection(socrates->getDirection(), SPRITE_WIDTH, sprayX, sprayY);
-    actors.push_front(new Spray(this, sprayX, sprayY, socrates->getDirection()));
+    addProjectile(new Spray(this, sprayX, sprayY, socrates->getDirection()));
 }
 
 void ActorWorld::sprayDamage(Projectile* spray) {
+    PROFILE_QUERY(QUERY_SPRAY_DAMAGE);
     for (auto itr = actors.begin(); itr != actors.end(); ) {
+        PROFILE_QUERY_VISIT();
         if ((*itr)->isAlive() && (*itr)->isDamageable() && spray->overlaps(spray, *itr)) {
             if ((*itr)->isCharacter()) {
                 Character* theCharacter = static_cast<Character*>(*itr); // *itr is guaranteed to be a Character
@@ -210,8 +323,151 @@ void ActorWorld::rechargeFlamethrower() {
 /////////////////////////////////////////////////////////////////
 // Fungus Auxiliary Function
 /////////////////////////////////////////////////////////////////
-void ActorWorld::fungusHurtSocrates() {
-    socrates->damageCharacter(20);
+void ActorWorld::fungusHurtSocrates(int damage) {
+    socrates->damageCharacter(damage);
+}
+
+/////////////////////////////////////////////////
+// Scenario Functions
+/////////////////////////////////////////////////
+void ActorWorld::clearActors() {
+    for (auto itr = actors.begin(); itr != actors.end(); ) {
+        destroyActor(*itr);
+        itr = actors.erase(itr);
+    }
+    m_bacteria = 0;
+    m_pits = 0;
+    m_eventCount = 0;
+}
+
+void ActorWorld::addPit(double x, double y) {
+    addActor(new Pit(this, x, y));
+    m_pits++;
+}
+
+void ActorWorld::addFood(double x, double y) {
+    addActor(new Food(this, x, y));
+}
+
+void ActorWorld::addDirt(double x, double y) {
+    addActor(new Dirt(this, x, y));
+}
+
+void ActorWorld::restoreSocrates() {
+    socrates->restoreHealthToFull();
+}
+
+int ActorWorld::actorCount() const {
+    return static_cast<int>(actors.size());
+}
+
+const Socrates* ActorWorld::getSocrates() const {
+    return socrates;
+}
+
+void ActorWorld::visitActors(ActorVisitor visit, void* context) const {
+    for (const Actor* actor : actors)
+        if (actor->isAlive())
+            visit(actor, context);
+}
+
+const OccupancyGrid& ActorWorld::occupancy() const {
+    return m_occupancy;
+}
+
+void ActorWorld::actorChangedCell(Actor* actor, int cell) {
+    m_occupancy.move(occupancyLayerOf(actor->getType()), actor->occupancyCell(), cell);
+    actor->setOccupancyCell(cell);
+}
+
+uint64_t ActorWorld::stateHash() const {
+        // Summed, so that the actors hash the same whatever order they're
+        // kept in, and so that one actor's hash can be swapped for its new one
+    if (!m_hashing) {
+        m_hashing = true;
+        m_actorsHash = 0;
+        if (socrates != nullptr) {
+            socrates->setHashedState(socrates->stateHash());
+            m_actorsHash += socrates->hashedState();
+        }
+        for (Actor* actor : actors) {
+            actor->setHashedState(actor->stateHash());
+            m_actorsHash += actor->hashedState();
+        }
+    }
+    for (Actor* actor : m_rehash) {
+        if (actor == nullptr)
+            continue;
+        uint64_t hash = actor->stateHash();
+        m_actorsHash += hash - actor->hashedState();
+        actor->setHashedState(hash);
+        actor->setRehashSlot(-1);
+    }
+    m_rehash.clear();
+    
+    StateHasher h;
+    h.add(m_ticks);
+    h.add(getScore());
+    h.add(getLevel());
+    h.add(getLives());
+    h.add(m_bacteria);
+    h.add(m_pits);
+    h.add(m_nextActorId);
+    
+        // Where the random sequence has got to
+    h.add(randEngine().startSeed());
+    h.add(randEngine().draws());
+    
+    h.add(m_actorsHash);
+    return h.value();
+}
+
+void ActorWorld::actorStateChanged(Actor* actor) {
+    if (!m_hashing || actor->rehashSlot() >= 0)
+        return;
+    actor->setRehashSlot(static_cast<int>(m_rehash.size()));
+    m_rehash.push_back(actor);
+}
+
+void ActorWorld::addActor(Actor* actor) {
+    actor->setId(m_nextActorId++);
+    actors.push_back(actor);
+    m_memory.actorCreated(actor->getType());
+    actorStateChanged(actor);
+    
+    int layer = occupancyLayerOf(actor->getType());
+    if (layer >= 0) {
+        int cell = OccupancyGrid::cellOf(actor->getX(), actor->getY());
+        m_occupancy.add(layer, cell);
+        actor->setOccupancyCell(cell);
+    }
+}
+
+void ActorWorld::addProjectile(Actor* projectile) {
+    projectile->setId(m_nextActorId++);
+    actors.push_front(projectile);
+    m_memory.actorCreated(projectile->getType());
+    actorStateChanged(projectile);
+}
+
+void ActorWorld::destroyActor(Actor* actor) {
+    m_memory.actorDestroyed(actor->getType());
+    if (actor->occupancyCell() >= 0)
+        m_occupancy.remove(occupancyLayerOf(actor->getType()), actor->occupancyCell());
+    if (m_hashing) {
+        m_actorsHash -= actor->hashedState();
+        if (actor->rehashSlot() >= 0)
+            m_rehash[actor->rehashSlot()] = nullptr;
+    }
+    delete actor;
+}
+
+int ActorWorld::countLive(ActorType type) const {
+    int count = 0;
+    for (const Actor* actor : actors)
+        if (actor->isAlive() && actor->getType() == type)
+            count++;
+    return count;
 }
 
 /////////////////////////////////////////////////
@@ -233,18 +489,22 @@ void ActorWorld::generateRandPosOnBorder(double& x, double& y) {
         y = sqrt((128 * 128) - pow(x - 128, 2)) + 128;
 }
 
-void ActorWorld::removeDeadActors() {
+int ActorWorld::removeDeadActors() {
+    int removed = 0;
     for (auto itr = actors.begin(); itr != actors.end(); ) {
         if (!(*itr)->isAlive()) {
-            delete *itr;
+            destroyActor(*itr);
             itr = actors.erase(itr);
+            removed++;
         } else {
             itr++;
         }
     }
+    return removed;
 }
 
-void ActorWorld::addGoodiesOrFungi() {
+int ActorWorld::addGoodiesOrFungi() {
+    int added = 0;
     int changeFungus = max(510 - getLevel() * 10, 200);
     int rand = randInt(0, changeFungus-1);              // [0, chanceFungus)
     
@@ -252,7 +512,8 @@ void ActorWorld::addGoodiesOrFungi() {
         double randX, randY;
         generateRandPosOnBorder(randX, randY);
         
-        actors.push_back(new Fungus(this, randX, randY));
+        addActor(new Fungus(this, randX, randY));
+        added++;
     }
     
     int chanceGoodie = max(510 - getLevel() * 10, 250);
@@ -265,34 +526,63 @@ void ActorWorld::addGoodiesOrFungi() {
         
         switch(randInt(1, 10)) {    // random number from a set of 10 elements
             case 1:     // 1 element == 10% chance
-                actors.push_back(new LifeGoodie(this, randX, randY));
+                addActor(new LifeGoodie(this, randX, randY));
                 break;
                 
             case 2:
             case 3:
             case 4:     // 3 elements == 30% chance
-                actors.push_back(new FlameGoodie(this, randX, randY));
+                addActor(new FlameGoodie(this, randX, randY));
                 break;
                  
             default:    // remaining elements == 60% chance
-                actors.push_back(new HealthGoodie(this, randX, randY));
+                addActor(new HealthGoodie(this, randX, randY));
                 break;
         }
+        added++;
     }
+    return added;
+}
+
+bool ActorWorld::StatusValues::operator==(const StatusValues& other) const {
+    return score == other.score && level == other.level && lives == other.lives &&
+           health == other.health && sprays == other.sprays && flames == other.flames;
 }
 
-void ActorWorld::updateStatusText() {
-    ostringstream statusText;
-    statusText.fill('0');
-    statusText << "Score: " << setw(6) << getScore();
-    statusText.fill(' ');
-    statusText << "  Level: " << setw(2) << getLevel();
-    statusText << "  Lives: " << setw(1) << getLives();
-    statusText << "  Health: " << setw(3) << socrates->getHealth();
-    statusText << "  Sprays: " << setw(2) << socrates->spraysRemaining();
-    statusText << "  Flames: " << setw(2) << socrates->flamesRemaining();
-    string status = statusText.str();
-    setGameStatText(status);
+    // Appends label then value right-aligned in width characters, padding with fill; returns the new end of the text
+static char* appendStat(char* out, const char* label, int value, int width, char fill) {
+    size_t labelLen = strlen(label);
+    memcpy(out, label, labelLen);
+    out += labelLen;
+    
+    char digits[16];
+    char* digitsEnd = to_chars(digits, digits + sizeof(digits), value).ptr;
+    int len = static_cast<int>(digitsEnd - digits);
+    for (int i = len; i < width; i++)
+        *out++ = fill;
+    memcpy(out, digits, len);
+    return out + len;
+}
+
+    // Only reformats the status line when one of its stats has actually changed
+bool ActorWorld::updateStatusText() {
+    StatusValues current = { getScore(), getLevel(), getLives(), socrates->getHealth(),
+                             socrates->spraysRemaining(), socrates->flamesRemaining() };
+    if (current == m_shownStatus)
+        return false;
+    m_shownStatus = current;
+    
+    char statusText[MAX_STATUS_TEXT];   // fits every label plus six 11-character ints
+    char* out = statusText;
+    out = appendStat(out, "Score: ", current.score, 6, '0');
+    out = appendStat(out, "  Level: ", current.level, 2, ' ');
+    out = appendStat(out, "  Lives: ", current.lives, 1, ' ');
+    out = appendStat(out, "  Health: ", current.health, 3, ' ');
+    out = appendStat(out, "  Sprays: ", current.sprays, 2, ' ');
+    out = appendStat(out, "  Flames: ", current.flames, 2, ' ');
+    *out = '\0';
+    setGameStatText(statusText);
+    return true;
 }
 
 /*////////////////////////////////////////////////////////////////*/
@@ -303,17 +593,23 @@ void ActorWorld::updateStatusText() {
 
 int ActorWorld::init()
 {
+    TRACE_SCOPE("ActorWorld::init");
     m_bacteria = 0;
     m_pits = 0;
+    m_shownStatus = StatusValues();     // force the status line to be redrawn
     
+    m_memory.beginLevel(getLevel());
     socrates = new Socrates(this);
+    socrates->setId(m_nextActorId++);
+    m_memory.actorCreated(ACTOR_SOCRATES);
+    actorStateChanged(socrates);
     
     for (int i = 0; i < getLevel(); i++) {
         double x, y;
         generateRandPos(x, y);
         
         if (getLevel() == 1) {
-            actors.push_back(new Pit(this, x, y));
+            addActor(new Pit(this, x, y));
             m_pits++;
             break;
         }
@@ -331,7 +627,7 @@ int ActorWorld::init()
             }
         }
         
-        actors.push_back(newPit);
+        addActor(newPit);
         m_pits++;
     }
     
@@ -352,7 +648,7 @@ int ActorWorld::init()
             }
         }
         
-        actors.push_back(newFood);
+        addActor(newFood);
     }
     
     for (int i = 0; i < max(180-20*getLevel(), 20); i++) {
@@ -372,7 +668,7 @@ int ActorWorld::init()
             }
         }
         
-        actors.push_back(newDirt);
+        addActor(newDirt);
     }
     
     return GWSTATUS_CONTINUE_GAME;
@@ -381,46 +677,107 @@ int ActorWorld::init()
 
 int ActorWorld::move()
 {
-    if (socrates->isAlive())
-        socrates->doSomething();
-    else
+    TRACE_SCOPE("tick");
+    m_ticks++;
+    m_profiler.beginTick();
+    fill(begin(m_population), end(m_population), 0);
+    int status = runTickPhases();
+    m_profiler.endTick();
+    m_memory.sampleContainers(actors.size());
+    
+        // An overrun explains itself with the ticks leading up to it
+    if (m_watchdog.record(m_profiler.lastTick(), m_population))
+        m_watchdog.dump(cout, getLevel(), m_bacteria, countLive(ACTOR_FLAME) + countLive(ACTOR_SPRAY));
+    return status;
+}
+
+const TickProfile& ActorWorld::lastTickProfile() const {
+    return m_profiler.lastTick();
+}
+
+void ActorWorld::observeTickPhases(TickPhaseObserver observer, void* context) {
+    m_profiler.setObserver(observer, context);
+}
+
+TickWatchdog& ActorWorld::watchdog() {
+    return m_watchdog;
+}
+
+void ActorWorld::reportMemoryTo(ostream* out) {
+    m_memoryReport = out;
+}
+
+long long ActorWorld::actorsCreated() const {
+    return m_memory.totalCreated();
+}
+
+int ActorWorld::runTickPhases() {
+        // Input: Socrates reacts to the keyboard
+    if (!socrates->isAlive())
         return GWSTATUS_PLAYER_DIED;    // this should never actually be called here; just an invariant check
+    {
+        PROFILE_ACTOR_UPDATE(socrates);
+        socrates->doSomething();
+    }
+    if (m_hashing)
+        actorStateChanged(socrates);
+    m_population[ACTOR_SOCRATES] = 1;
+    m_profiler.endPhase(PHASE_INPUT, 1);
     
-        // Traverse through list, letting all Actors do something if they're alive
-    for (auto itr = actors.begin(); itr != actors.end(); itr++) {
+        // Actors: traverse through list, letting all Actors do something if they're alive
+    int acted = 0;
+    for (auto itr = actors.begin(); itr != actors.end() && socrates->isAlive(); itr++) {
         if ((*itr)->isAlive()) {
+            PROFILE_ACTOR_UPDATE(*itr);
             (*itr)->doSomething();
-            
-            if (!socrates->isAlive()) {
-                decLives();
-                return GWSTATUS_PLAYER_DIED;
-            }
-
-            if (finishedLevel())
-                return GWSTATUS_FINISHED_LEVEL;
+            if (m_hashing && actorTypeActs((*itr)->getType()))
+                actorStateChanged(*itr);
+            m_population[(*itr)->getType()]++;
+            acted++;
         }
     }
+    m_profiler.endPhase(PHASE_ACTORS, acted);
+    
+        // Events: apply everything the Actors asked for this tick
+    m_profiler.endPhase(PHASE_EVENTS, drainEvents());
     
-    if (m_pits == 0 && m_bacteria == 0)
+    if (!socrates->isAlive()) {
+        decLives();
+        return GWSTATUS_PLAYER_DIED;
+    }
+    
+    if (finishedLevel())
         return GWSTATUS_FINISHED_LEVEL;
     
-    removeDeadActors();
+    m_profiler.endPhase(PHASE_CLEANUP, removeDeadActors());
     
-    addGoodiesOrFungi();
+    m_profiler.endPhase(PHASE_SPAWN, addGoodiesOrFungi());
     
-    updateStatusText();
+    m_profiler.endPhase(PHASE_STATUS, updateStatusText() ? 1 : 0);
     
     return GWSTATUS_CONTINUE_GAME;
-    
 }
 
 void ActorWorld::cleanUp()
 {
-    delete socrates;
-    socrates = nullptr;
+    TRACE_SCOPE("ActorWorld::cleanUp");
+    PROFILE_ACTORS_DUMP(cout);     // the level is over
+    
+    if (socrates != nullptr) {
+        destroyActor(socrates);
+        socrates = nullptr;
+    }
+    m_eventCount = 0;
 
     for (auto itr = actors.begin(); itr != actors.end(); ) {
-        delete *itr;
+        destroyActor(*itr);
         itr = actors.erase(itr);
     }
+    
+        // How big the level got, and whether it all came back
+    if (m_memoryReport != nullptr && m_memory.levelUsed()) {
+        m_memory.reportLevel(*m_memoryReport);
+        m_memory.checkReleased(*m_memoryReport);
+    }
+    m_memory.endLevel();
 }
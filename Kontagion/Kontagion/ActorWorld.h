@@ -2,13 +2,25 @@
 #define ACTORWORLD_H_
 
 #include "GameWorld.h"
+#include "WorldEvent.h"
+#include "TickProfile.h"
+#include "TickWatchdog.h"
+#include "MemoryAccounting.h"
+#include "OccupancyGrid.h"
 #include <string>
 #include <list>
+#include <vector>
+#include <cstdint>
 
 class Actor;
 class Socrates;
 class Projectile;
 class Bacteria;
+class InputPolicy;
+class ReplayRecorder;
+
+    // Called with each actor in turn by ActorWorld::visitActors
+typedef void (*ActorVisitor)(const Actor* actor, void* context);
 
 class ActorWorld : public GameWorld
 {
@@ -20,13 +32,29 @@ public:
     virtual int move();
     virtual void cleanUp();
     
+        // Where the last tick spent its time
+    const TickProfile& lastTickProfile() const;
+    void observeTickPhases(TickPhaseObserver observer, void* context);
+    TickWatchdog& watchdog();
+    
+        // Where the per-level and end-of-run memory reports go (cout unless changed; nullptr for none)
+    void reportMemoryTo(std::ostream* out);
+    long long actorsCreated() const;    // ever, by this world
+    
+        // World Events
+    void postEvent(WorldEventType type, int amount = 0, double x = 0, double y = 0);
+    bool subscribe(WorldEventListener listener, void* context);
+    void unsubscribe(WorldEventListener listener, void* context);
+    
         // General Auxiliary Functions
-    void decPitCount();
-    void decBacteriaCount();
     bool finishedLevel() const;
     
         // Socrates Auxiliary Functions
     bool socratesOverlap(Actor* actor);
+    void setInputPolicy(InputPolicy* policy);       // nullptr for the keyboard
+    bool playerKey(int& key);                       // the key Socrates acts on this tick, if any
+    void recordInputTo(ReplayRecorder* recorder);   // the keys pressed, and how the run ends; nullptr for none
+    long long ticks() const;                        // moves made, over every level, by this world
     
         // Bacteria Auxiliary Functions
     bool bacteriaSocratesOverlap(Bacteria* bacteria);
@@ -34,7 +62,6 @@ public:
     bool nearSocrates(Bacteria* aggSal, double& socratesX, double& socratesY, const double& dist);
     bool canEatFood(Bacteria* bacteria);
     bool findFood(Bacteria* bacteria, double& foodX, double& foodY);
-    void dropFood(double x, double y);
     
     
         // Bacteria Spawning Functions
@@ -50,14 +77,29 @@ public:
     void sprayDisinfectant();
     void sprayDamage(Projectile* spray);
     
-        // Health Goodie Auxiliary Functions
-    void healSocrates();
+        // Scenario Functions - let benchmarks and tools set up a dish by hand after init()
+    void clearActors();                 // removes everything except Socrates
+    void addPit(double x, double y);
+    void addFood(double x, double y);
+    void addDirt(double x, double y);
+    void restoreSocrates();             // back to full health, so long runs don't end early
+    int actorCount() const;
+    void generateRandPos(double& x, double& y);
     
-        // Flamethrower Goodie Auxiliary Functions
-    void rechargeFlamethrower();
+        // Read-only views for agents and tools
+    const Socrates* getSocrates() const;
+    void visitActors(ActorVisitor visit, void* context) const;     // the live ones, except Socrates
+    const OccupancyGrid& occupancy() const;
+    void actorChangedCell(Actor* actor, int cell);      // from Actor::moveTo
     
-        // Fungus Auxiliary Functions
-    void fungusHurtSocrates();
+        // A hash of everything that decides how the game plays on: every
+        // actor's state, the score, level and lives, the counts the world
+        // keeps, and where the random sequence has got to.  Two runs whose
+        // hashes agree after every tick played exactly the same.  The first
+        // call hashes every actor; after that the world keeps a running sum
+        // and rehashes only the actors that acted, were hurt or died since.
+    std::uint64_t stateHash() const;
+    void actorStateChanged(Actor* actor);   // rehash it before the next stateHash
 
 private:
     Socrates* socrates;
@@ -65,12 +107,59 @@ private:
     int m_bacteria;
     int m_pits;
     
+        // The stats last shown on the status line
+    struct StatusValues {
+        int score, level, lives, health, sprays, flames;
+        bool operator==(const StatusValues& other) const;
+    };
+    StatusValues m_shownStatus;
+    
+        // Events posted this tick, and who wants to hear about them
+    WorldEvent m_events[MAX_WORLD_EVENTS];
+    int m_eventCount;
+    struct EventSubscriber {
+        WorldEventListener listener;
+        void* context;
+    };
+    EventSubscriber m_subscribers[MAX_WORLD_EVENT_LISTENERS];
+    int m_subscriberCount;
+    
+    TickProfiler m_profiler;
+    TickWatchdog m_watchdog;
+    int m_population[NUM_ACTOR_TYPES];     // live actors of each type seen this tick
+    MemoryAccounting m_memory;
+    OccupancyGrid m_occupancy;
+    std::ostream* m_memoryReport;
+    InputPolicy* m_inputPolicy;
+    ReplayRecorder* m_recorder;
+    long long m_ticks;
+    unsigned int m_nextActorId;
+    
+        // The running state hash, kept once stateHash has been asked for
+    mutable bool m_hashing;
+    mutable std::uint64_t m_actorsHash;     // the sum of the actors' hashedState()s
+    mutable std::vector<Actor*> m_rehash;   // changed since; nullptr where one was destroyed
+    
+        // Event Handlers
+    int drainEvents();
+    void applyEvent(const WorldEvent& event);
+    void decPitCount();
+    void decBacteriaCount();
+    void dropFood(double x, double y);
+    void healSocrates();
+    void fungusHurtSocrates(int damage);
+    void rechargeFlamethrower();
+    
         // Supporting Functions
-    void generateRandPos(double& x, double& y);
     void generateRandPosOnBorder(double& x, double& y);
-    void removeDeadActors();
-    void addGoodiesOrFungi();
-    void updateStatusText();
+    int runTickPhases();
+    int countLive(ActorType type) const;
+    void addActor(Actor* actor);
+    void addProjectile(Actor* projectile);
+    void destroyActor(Actor* actor);
+    int removeDeadActors();
+    int addGoodiesOrFungi();
+    bool updateStatusText();
 };
 
 #endif // ACTORWORLD_H_
@@ -0,0 +1,248 @@
+#include "AllocCounter.h"
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#ifdef KONTAGION_ALLOC_TRACKING
+#include <execinfo.h>
+#include <cxxabi.h>
+#include <sstream>
+#endif
+using namespace std;
+
+static atomic<unsigned long long> s_allocations(0);
+static atomic<unsigned long long> s_bytes(0);
+static atomic<unsigned long long> s_deallocations(0);
+
+unsigned long long allocationCount()
+{
+    return s_allocations.load(memory_order_relaxed);
+}
+
+unsigned long long allocatedBytes()
+{
+    return s_bytes.load(memory_order_relaxed);
+}
+
+unsigned long long deallocationCount()
+{
+    return s_deallocations.load(memory_order_relaxed);
+}
+
+#ifdef KONTAGION_ALLOC_TRACKING
+
+  // Only one thread is expected to track at a time; the table isn't shared
+  // safely between several.
+static const int SITE_TABLE_SIZE = 512;
+static AllocationSite s_sites[SITE_TABLE_SIZE];
+static unsigned long long s_untracked = 0;
+static thread_local bool t_tracking = false;
+static thread_local bool t_recording = false;     // backtrace itself may allocate
+
+  // Frames belonging to the allocator: recordSite, countedAlloc and operator
+  // new, which must therefore not be inlined into each other
+static const int SKIPPED_FRAMES = 3;
+#define ALLOCATOR_FRAME __attribute__((noinline))
+
+static ALLOCATOR_FRAME void recordSite(size_t size)
+{
+    if (t_recording)
+        return;
+    t_recording = true;
+
+    void* frames[MAX_ALLOCATION_FRAMES + SKIPPED_FRAMES];
+    int depth = backtrace(frames, MAX_ALLOCATION_FRAMES + SKIPPED_FRAMES) - SKIPPED_FRAMES;
+    if (depth < 0)
+        depth = 0;
+    size_t hash = static_cast<size_t>(depth);
+    for (int i = 0; i < depth; i++)
+        hash = hash * 31 + reinterpret_cast<size_t>(frames[SKIPPED_FRAMES + i]);
+
+    for (int probe = 0; probe < SITE_TABLE_SIZE; probe++)
+    {
+        AllocationSite& site = s_sites[(hash + probe) % SITE_TABLE_SIZE];
+        if (site.count == 0)
+        {
+            memcpy(site.frames, frames + SKIPPED_FRAMES, depth * sizeof(void*));
+            site.depth = depth;
+        }
+        else if (site.depth != depth  ||  memcmp(site.frames, frames + SKIPPED_FRAMES, depth * sizeof(void*)) != 0)
+            continue;
+        site.count++;
+        site.bytes += size;
+        t_recording = false;
+        return;
+    }
+    s_untracked++;
+    t_recording = false;
+}
+
+bool allocationSitesTracked()
+{
+    return true;
+}
+
+void trackAllocationSites(bool on)
+{
+    if (on)
+    {
+          // The first backtrace loads the unwinder; get that over with
+        void* frame;
+        t_recording = true;
+        backtrace(&frame, 1);
+        t_recording = false;
+    }
+    t_tracking = on;
+}
+
+void drainAllocationSites(void (*visit)(const AllocationSite& site, void* context), void* context)
+{
+    bool wasTracking = t_tracking;
+    t_tracking = false;
+    for (AllocationSite& site : s_sites)
+    {
+        if (site.count == 0)
+            continue;
+        visit(site, context);
+        site.count = 0;
+        site.bytes = 0;
+    }
+    t_tracking = wasTracking;
+}
+
+unsigned long long untrackedAllocations()
+{
+    return s_untracked;
+}
+
+string describeAllocationSite(const AllocationSite& site, const char* indent)
+{
+    ostringstream oss;
+    char** symbols = backtrace_symbols(site.frames, site.depth);
+    for (int i = 0; i < site.depth; i++)
+    {
+          // Typically "binary(mangled+0x1f) [0x...]"; demangle the middle
+        string line = (symbols != nullptr ? symbols[i] : "?");
+        size_t open = line.find('(');
+        size_t plus = line.find('+', open);
+        if (open != string::npos  &&  plus != string::npos  &&  plus > open + 1)
+        {
+            string mangled = line.substr(open + 1, plus - open - 1);
+            int status;
+            char* name = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+            if (status == 0  &&  name != nullptr)
+                line.replace(open + 1, plus - open - 1, name);
+            free(name);
+        }
+        oss << indent << line << '\n';
+    }
+    free(symbols);
+    return oss.str();
+}
+
+#else
+
+#define ALLOCATOR_FRAME
+
+static inline void recordSite(size_t)
+{
+}
+
+static const bool t_tracking = false;
+
+bool allocationSitesTracked()
+{
+    return false;
+}
+
+void trackAllocationSites(bool)
+{
+}
+
+void drainAllocationSites(void (*)(const AllocationSite&, void*), void*)
+{
+}
+
+unsigned long long untrackedAllocations()
+{
+    return 0;
+}
+
+string describeAllocationSite(const AllocationSite&, const char*)
+{
+    return string();
+}
+
+#endif // KONTAGION_ALLOC_TRACKING
+
+static ALLOCATOR_FRAME void* countedAlloc(size_t size)
+{
+    s_allocations.fetch_add(1, memory_order_relaxed);
+    s_bytes.fetch_add(size, memory_order_relaxed);
+    if (t_tracking)
+        recordSite(size);
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void countedFree(void* p)
+{
+    if (p != nullptr)
+        s_deallocations.fetch_add(1, memory_order_relaxed);
+    free(p);
+}
+
+void* operator new(size_t size)
+{
+    void* p = countedAlloc(size);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    void* p = countedAlloc(size);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+    countedFree(p);
+}
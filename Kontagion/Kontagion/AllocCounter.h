@@ -0,0 +1,46 @@
+#ifndef ALLOCCOUNTER_H_
+#define ALLOCCOUNTER_H_
+
+#include <string>
+
+  // Every heap allocation the program makes goes through the replacement
+  // global operator new in AllocCounter.cpp, which keeps these running totals.
+  // Counting costs one relaxed atomic add per call, so it is always on; take
+  // the difference of two readings to see what some code allocated.
+
+unsigned long long allocationCount();
+unsigned long long allocatedBytes();
+unsigned long long deallocationCount();
+
+  // Builds with KONTAGION_ALLOC_TRACKING defined can also say where the
+  // allocations came from.  While a thread has tracking on, each allocation
+  // it makes is charged to its call stack in a fixed table (so recording
+  // never allocates itself).  Elsewhere these do nothing and
+  // allocationSitesTracked() is false.  Link with -rdynamic to get function
+  // names rather than bare addresses.
+
+const int MAX_ALLOCATION_FRAMES = 8;
+
+struct AllocationSite
+{
+    void*              frames[MAX_ALLOCATION_FRAMES];   // innermost first
+    int                depth;
+    unsigned long long count;
+    unsigned long long bytes;
+};
+
+bool allocationSitesTracked();
+
+  // Turn recording on or off for the calling thread
+void trackAllocationSites(bool on);
+
+  // Hand every site recorded since the last drain to visit, then forget them
+void drainAllocationSites(void (*visit)(const AllocationSite& site, void* context), void* context);
+
+  // Allocations not recorded because the table was full
+unsigned long long untrackedAllocations();
+
+  // The site's call stack, one frame per line, each line starting with indent
+std::string describeAllocationSite(const AllocationSite& site, const char* indent);
+
+#endif // ALLOCCOUNTER_H_
@@ -0,0 +1,56 @@
+#ifndef ASSETMANIFEST_H_
+#define ASSETMANIFEST_H_
+
+#include "GameConstants.h"
+
+  // Every asset file the game uses.  Both the game and the asset packer
+  // work from these tables.
+
+struct SpriteAsset
+{
+    int         imageID;
+    int         frameNum;
+    const char* tgaFileName;
+};
+
+struct SoundAsset
+{
+    int         soundID;
+    const char* wavFileName;
+};
+
+const SpriteAsset SPRITE_ASSETS[] = {
+	{ IID_PLAYER               , 0, "socrates.tga" },
+	{ IID_SALMONELLA           , 0, "salmonella1.tga" },
+	{ IID_SALMONELLA           , 1, "salmonella2.tga" },
+	{ IID_ECOLI                , 0, "ecoli1.tga" },
+	{ IID_ECOLI                , 1, "ecoli2.tga" },
+	{ IID_SPRAY                , 0, "water1.tga" },
+	{ IID_SPRAY                , 1, "water2.tga" },
+	{ IID_SPRAY                , 2, "water3.tga" },
+	{ IID_FLAME                , 0, "explosion.tga" },
+	{ IID_PIT                  , 0, "hole.tga" },
+	{ IID_FLAME_THROWER_GOODIE , 0, "flamethrow.tga" },
+	{ IID_RESTORE_HEALTH_GOODIE, 0, "health.tga" },
+	{ IID_EXTRA_LIFE_GOODIE    , 0, "life.tga" },
+	{ IID_FUNGUS               , 0, "fungus.tga" },
+	{ IID_DIRT                 , 0, "dirt.tga" },
+	{ IID_FOOD                 , 0, "pizza.tga" },
+};
+
+const SoundAsset SOUND_ASSETS[] = {
+	{ SOUND_PLAYER_FIRE    , "flame.wav" },
+	{ SOUND_SALMONELLA_HURT, "hurt.wav" },
+	{ SOUND_ECOLI_HURT     , "hurt.wav" },
+	{ SOUND_PLAYER_DIE     , "die.wav" },
+	{ SOUND_GOT_GOODIE     , "goodie.wav" },
+	{ SOUND_FINISHED_LEVEL , "finished.wav" },
+	{ SOUND_PLAYER_SPRAY   , "squirt.wav" },
+	{ SOUND_ECOLI_DIE      , "scream.wav" },
+	{ SOUND_SALMONELLA_DIE , "scream.wav" },
+	{ SOUND_THEME          , "theme.wav" },
+	{ SOUND_PLAYER_HURT    , "ouch.wav" },
+	{ SOUND_BACTERIUM_BORN , "born.wav" },
+};
+
+#endif // ASSETMANIFEST_H_
@@ -0,0 +1,377 @@
+#include "AssetPack.h"
+#include "AssetManifest.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+using namespace std;
+
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+Pack layout.  All integers are 32-bit little-endian.
+
+  header (16 bytes):  magic "KPAK", version, entry count, reserved
+  entries (64 bytes each):
+      name (32 bytes, '\0' padded), kind, data offset, data size,
+      sprite: width, height, mip level count
+      sound:  sample rate, channels, bits per sample
+      two reserved words
+  data:  each entry's data starts on a 16-byte boundary.  A sprite's data
+         is its RGBA mip levels back to back, largest first.
+*/
+
+static const char PACK_MAGIC[4] = { 'K', 'P', 'A', 'K' };
+static const unsigned int PACK_VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+static const size_t ENTRY_SIZE = 64;
+static const size_t NAME_SIZE = 32;
+static const size_t DATA_ALIGNMENT = 16;
+
+enum PackEntryKind : unsigned int { pack_sprite = 1, pack_sound = 2 };
+
+static unsigned int readU32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+static void writeU32(vector<unsigned char>& out, unsigned int v)
+{
+    out.push_back(static_cast<unsigned char>(v));
+    out.push_back(static_cast<unsigned char>(v >> 8));
+    out.push_back(static_cast<unsigned char>(v >> 16));
+    out.push_back(static_cast<unsigned char>(v >> 24));
+}
+
+static unsigned int mipLevelSize(unsigned int width, unsigned int height, unsigned int level)
+{
+    return max(width >> level, 1u) * max(height >> level, 1u) * 4;
+}
+
+bool readAssetFile(const string& path, vector<char>& contents)
+{
+    ifstream file(path, ios::in|ios::binary);
+    if (!file)
+        return false;
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    file.seekg(0);
+    contents.resize(static_cast<size_t>(size));
+    file.read(contents.data(), size);
+    return static_cast<bool>(file);
+}
+
+bool decodeTga(const char* data, size_t size, DecodedImage& image)
+{
+    if (size < 18)
+        return false;
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(data);
+
+      //image type either 2 (color) or 3 (greyscale)
+    if (header[1] != 0 || (header[2] != 2 && header[2] != 3))
+        return false;
+
+    unsigned int width = header[12] + header[13] * 256;
+    unsigned int height = header[14] + header[15] * 256;
+    unsigned int byteCount = header[16] / 8;
+    if (byteCount != 3 && byteCount != 4)
+        return false;
+    if (size < 18 + size_t(width) * height * byteCount)
+        return false;
+
+      // TGA pixels are BGR(A); GL gets RGBA
+    image.width = width;
+    image.height = height;
+    image.levels.assign(1, vector<unsigned char>(size_t(width) * height * 4));
+    const unsigned char* in = header + 18;
+    unsigned char* out = image.levels[0].data();
+    for (size_t i = 0; i < size_t(width) * height; i++, in += byteCount, out += 4)
+    {
+        out[0] = in[2];
+        out[1] = in[1];
+        out[2] = in[0];
+        out[3] = (byteCount == 4 ? in[3] : 255);
+    }
+    return true;
+}
+
+void buildMipChain(DecodedImage& image)
+{
+    image.levels.resize(1);
+    unsigned int w = image.width;
+    unsigned int h = image.height;
+    while ((w > 1 || h > 1) && image.levels.size() < MAX_MIP_LEVELS)
+    {
+        unsigned int nw = max(w / 2, 1u);
+        unsigned int nh = max(h / 2, 1u);
+        const vector<unsigned char>& src = image.levels.back();
+        vector<unsigned char> dst(size_t(nw) * nh * 4);
+        for (unsigned int y = 0; y < nh; y++)
+        {
+            unsigned int y0 = min(2 * y, h - 1), y1 = min(2 * y + 1, h - 1);
+            for (unsigned int x = 0; x < nw; x++)
+            {
+                unsigned int x0 = min(2 * x, w - 1), x1 = min(2 * x + 1, w - 1);
+                for (int c = 0; c < 4; c++)
+                {
+                    unsigned int sum = src[(size_t(y0) * w + x0) * 4 + c] + src[(size_t(y0) * w + x1) * 4 + c]
+                                     + src[(size_t(y1) * w + x0) * 4 + c] + src[(size_t(y1) * w + x1) * 4 + c];
+                    dst[(size_t(y) * nw + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        image.levels.push_back(move(dst));
+        w = nw;
+        h = nh;
+    }
+}
+
+bool decodeWav(const char* data, size_t size, DecodedSound& sound)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool haveFormat = false;
+    size_t pos = 12;
+    while (pos + 8 <= size)
+    {
+        const unsigned char* chunk = p + pos;
+        size_t chunkSize = readU32(chunk + 4);
+        size_t available = min(chunkSize, size - pos - 8);
+        if (memcmp(chunk, "fmt ", 4) == 0  &&  available >= 16)
+        {
+            unsigned int format = chunk[8] | (chunk[9] << 8);
+            sound.channels = chunk[10] | (chunk[11] << 8);
+            sound.sampleRate = readU32(chunk + 12);
+            sound.bitsPerSample = chunk[22] | (chunk[23] << 8);
+            if (format != 1  ||  (sound.bitsPerSample != 8 && sound.bitsPerSample != 16)
+                             ||  sound.channels == 0)
+                return false;
+            haveFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0  &&  haveFormat)
+        {
+            sound.samples.assign(chunk + 8, chunk + 8 + available);
+            return true;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);     // chunks are word aligned
+    }
+    return false;
+}
+
+AssetPack::AssetPack()
+ : m_data(nullptr), m_size(0), m_mapped(false), m_entryCount(0)
+{
+}
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+bool AssetPack::open(const string& packPath)
+{
+    close();
+#ifdef _MSC_VER
+    vector<char> contents;
+    if (!readAssetFile(packPath, contents))
+        return false;
+    m_buffer.assign(contents.begin(), contents.end());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    int fd = ::open(packPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0  ||  statbuf.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+    m_data = static_cast<const unsigned char*>(mapping);
+    m_size = statbuf.st_size;
+    m_mapped = true;
+#endif
+
+    if (m_size < HEADER_SIZE  ||  memcmp(m_data, PACK_MAGIC, 4) != 0
+                              ||  readU32(m_data + 4) != PACK_VERSION)
+    {
+        close();
+        return false;
+    }
+    m_entryCount = readU32(m_data + 8);
+    if (HEADER_SIZE + size_t(m_entryCount) * ENTRY_SIZE > m_size)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close()
+{
+#ifndef _MSC_VER
+    if (m_mapped)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_entryCount = 0;
+}
+
+const unsigned char* AssetPack::findEntry(const string& name, unsigned int kind) const
+{
+    if (m_data == nullptr  ||  name.size() >= NAME_SIZE)
+        return nullptr;
+    for (unsigned int i = 0; i < m_entryCount; i++)
+    {
+        const unsigned char* entry = m_data + HEADER_SIZE + size_t(i) * ENTRY_SIZE;
+        if (readU32(entry + 32) == kind  &&  strncmp(reinterpret_cast<const char*>(entry), name.c_str(), NAME_SIZE) == 0)
+        {
+            size_t offset = readU32(entry + 36);
+            size_t size = readU32(entry + 40);
+            if (offset + size > m_size)
+                return nullptr;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetPack::findSprite(const string& name, PackedSprite& sprite) const
+{
+    const unsigned char* entry = findEntry(name, pack_sprite);
+    if (entry == nullptr)
+        return false;
+    sprite.width = readU32(entry + 44);
+    sprite.height = readU32(entry + 48);
+    sprite.levelCount = readU32(entry + 52);
+    if (sprite.levelCount == 0  ||  sprite.levelCount > MAX_MIP_LEVELS)
+        return false;
+
+    size_t offset = readU32(entry + 36);
+    size_t end = offset + readU32(entry + 40);
+    for (unsigned int level = 0; level < sprite.levelCount; level++)
+    {
+        sprite.levels[level] = m_data + offset;
+        offset += mipLevelSize(sprite.width, sprite.height, level);
+    }
+    return offset <= end;
+}
+
+bool AssetPack::findSound(const string& name, PackedSound& sound) const
+{
+    const unsigned char* entry = findEntry(name, pack_sound);
+    if (entry == nullptr)
+        return false;
+    sound.sampleRate = readU32(entry + 44);
+    sound.channels = readU32(entry + 48);
+    sound.bitsPerSample = readU32(entry + 52);
+    sound.samples = m_data + readU32(entry + 36);
+    sound.bytes = readU32(entry + 40);
+    return true;
+}
+
+bool AssetPack::write(const string& assetPath, const string& packPath)
+{
+    vector<unsigned char> index;
+    vector<unsigned char> data;
+    unsigned int entryCount = 0;
+    size_t manifestEntries = size(SPRITE_ASSETS) + size(SOUND_ASSETS);
+    size_t dataStart = HEADER_SIZE + manifestEntries * ENTRY_SIZE;
+
+    auto addEntry = [&](const char* name, unsigned int kind, const vector<unsigned char>& bytes,
+                        unsigned int a, unsigned int b, unsigned int c)
+    {
+          // The same file can appear more than once in the manifest
+        for (unsigned int i = 0; i < entryCount; i++)
+            if (strncmp(reinterpret_cast<const char*>(&index[i * ENTRY_SIZE]), name, NAME_SIZE) == 0)
+                return;
+        while (data.size() % DATA_ALIGNMENT != 0)
+            data.push_back(0);
+        char paddedName[NAME_SIZE] = {};
+        strncpy(paddedName, name, NAME_SIZE - 1);
+        index.insert(index.end(), paddedName, paddedName + NAME_SIZE);
+        writeU32(index, kind);
+        writeU32(index, static_cast<unsigned int>(dataStart + data.size()));
+        writeU32(index, static_cast<unsigned int>(bytes.size()));
+        writeU32(index, a);
+        writeU32(index, b);
+        writeU32(index, c);
+        writeU32(index, 0);
+        writeU32(index, 0);
+        data.insert(data.end(), bytes.begin(), bytes.end());
+        entryCount++;
+    };
+
+    for (const SpriteAsset& s : SPRITE_ASSETS)
+    {
+        vector<char> contents;
+        DecodedImage image;
+        if (!readAssetFile(assetPath + s.tgaFileName, contents)  ||
+            !decodeTga(contents.data(), contents.size(), image))
+        {
+            cout << "Cannot read sprite " << assetPath + s.tgaFileName << endl;
+            return false;
+        }
+        buildMipChain(image);
+        vector<unsigned char> bytes;
+        for (const vector<unsigned char>& level : image.levels)
+            bytes.insert(bytes.end(), level.begin(), level.end());
+        addEntry(s.tgaFileName, pack_sprite, bytes, image.width, image.height,
+                 static_cast<unsigned int>(image.levels.size()));
+    }
+
+    for (const SoundAsset& s : SOUND_ASSETS)
+    {
+        vector<char> contents;
+        DecodedSound sound;
+        if (!readAssetFile(assetPath + s.wavFileName, contents))
+        {
+            cout << "Skipping missing sound " << assetPath + s.wavFileName << endl;
+            continue;
+        }
+        if (!decodeWav(contents.data(), contents.size(), sound))
+        {
+            cout << "Skipping unsupported sound " << assetPath + s.wavFileName << endl;
+            continue;
+        }
+        addEntry(s.wavFileName, pack_sound, sound.samples, sound.sampleRate, sound.channels, sound.bitsPerSample);
+    }
+
+      // Entries were only reserved for every manifest line, so pad the index
+      // out to where the data was laid out to begin.
+    index.resize(manifestEntries * ENTRY_SIZE, 0);
+
+    vector<unsigned char> header(PACK_MAGIC, PACK_MAGIC + 4);
+    writeU32(header, PACK_VERSION);
+    writeU32(header, entryCount);
+    writeU32(header, 0);
+
+    ofstream out(packPath, ios::out|ios::binary|ios::trunc);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out.write(reinterpret_cast<const char*>(index.data()), index.size());
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!out)
+    {
+        cout << "Cannot write " << packPath << endl;
+        return false;
+    }
+    cout << "Wrote " << entryCount << " assets (" << HEADER_SIZE + index.size() + data.size()
+         << " bytes) to " << packPath << endl;
+    return true;
+}
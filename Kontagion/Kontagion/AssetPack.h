@@ -0,0 +1,103 @@
+#ifndef ASSETPACK_H_
+#define ASSETPACK_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+  // Name of the pre-baked pack, looked for in the asset directory
+const char* const ASSET_PACK_NAME = "kontagion.pak";
+
+const int MAX_MIP_LEVELS = 16;
+
+  // An RGBA image plus its full mipmap chain, largest level first
+struct DecodedImage
+{
+    unsigned int width;
+    unsigned int height;
+    std::vector<std::vector<unsigned char>> levels;
+};
+
+  // PCM sample data as stored in a WAV file
+struct DecodedSound
+{
+    unsigned int sampleRate;
+    unsigned int channels;
+    unsigned int bitsPerSample;
+    std::vector<unsigned char> samples;
+};
+
+bool readAssetFile(const std::string& path, std::vector<char>& contents);
+
+  // Decode an uncompressed 24- or 32-bit TGA into RGBA; the mip chain is
+  // left to buildMipChain.
+bool decodeTga(const char* data, std::size_t size, DecodedImage& image);
+
+  // Box-filter levels[0] down to 1x1, replacing any existing smaller levels
+void buildMipChain(DecodedImage& image);
+
+bool decodeWav(const char* data, std::size_t size, DecodedSound& sound);
+
+  // A sprite stored in a pack; the level pointers point into the pack itself
+struct PackedSprite
+{
+    unsigned int         width;
+    unsigned int         height;
+    unsigned int         levelCount;
+    const unsigned char* levels[MAX_MIP_LEVELS];
+};
+
+  // A sound stored in a pack; samples point into the pack itself
+struct PackedSound
+{
+    unsigned int         sampleRate;
+    unsigned int         channels;
+    unsigned int         bitsPerSample;
+    const unsigned char* samples;
+    std::size_t          bytes;
+};
+
+  // A single indexed file holding every sprite already decoded and
+  // mipmapped, and every sound already decoded to PCM.  The game maps the
+  // file and hands GL pointers straight into the mapping.
+class AssetPack
+{
+  public:
+    AssetPack();
+    ~AssetPack();
+
+    bool open(const std::string& packPath);
+    void close();
+    bool isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+      // Size of the pack, whether mapped or read into memory
+    std::size_t bytes() const
+    {
+        return m_size;
+    }
+
+    bool findSprite(const std::string& name, PackedSprite& sprite) const;
+    bool findSound(const std::string& name, PackedSound& sound) const;
+
+      // The offline packer: bake every file in the asset manifest found in
+      // assetPath into packPath.  Returns false if a sprite is missing or
+      // unreadable; missing sounds are skipped.
+    static bool write(const std::string& assetPath, const std::string& packPath);
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+  private:
+    const unsigned char*       m_data;
+    std::size_t                m_size;
+    bool                       m_mapped;
+    std::vector<unsigned char> m_buffer;    // used where the file can't be mapped
+    unsigned int               m_entryCount;
+
+    const unsigned char* findEntry(const std::string& name, unsigned int kind) const;
+};
+
+#endif // ASSETPACK_H_
@@ -0,0 +1,180 @@
+#include "AudioMixer.h"
+#include "GameConstants.h"
+#include <algorithm>
+using namespace std;
+
+AudioMixer::AudioMixer()
+ : m_running(false), m_freeVoices(MAX_MIXER_VOICES)
+{
+    m_pushLock.clear();
+    for (Voice& v : m_voices)
+    {
+        v.clip = nullptr;
+        v.frame = 0;
+    }
+}
+
+AudioMixer::~AudioMixer()
+{
+    stop();
+}
+
+bool AudioMixer::loadSound(int soundID, const DecodedSound& sound)
+{
+    return loadSound(soundID, sound.samples.data(), sound.samples.size(),
+                     sound.sampleRate, sound.channels, sound.bitsPerSample);
+}
+
+bool AudioMixer::loadSound(int soundID, const PackedSound& sound)
+{
+    return loadSound(soundID, sound.samples, sound.bytes,
+                     sound.sampleRate, sound.channels, sound.bitsPerSample);
+}
+
+bool AudioMixer::loadSound(int soundID, const unsigned char* samples, size_t bytes,
+                           unsigned int sampleRate, unsigned int channels, unsigned int bitsPerSample)
+{
+    if (soundID < 0  ||  sampleRate == 0  ||  channels == 0  ||
+        (bitsPerSample != 8  &&  bitsPerSample != 16))
+        return false;
+
+    size_t bytesPerSample = bitsPerSample / 8;
+    size_t sourceFrames = bytes / (bytesPerSample * channels);
+    if (sourceFrames == 0)
+        return false;
+
+      // Read one sample of the source as signed 16-bit
+    auto sample = [&](size_t frame, unsigned int channel) -> int
+    {
+        const unsigned char* p = samples + (frame * channels + min(channel, channels - 1)) * bytesPerSample;
+        if (bitsPerSample == 8)
+            return (p[0] - 128) * 256;
+        return static_cast<int16_t>(p[0] | (p[1] << 8));
+    };
+
+      // Convert to the mixer's rate and channel count, interpolating linearly
+      // between source frames.  Mono is copied to both channels.
+    size_t frames = static_cast<size_t>(static_cast<uint64_t>(sourceFrames) * MIXER_SAMPLE_RATE / sampleRate);
+    if (static_cast<size_t>(soundID) >= m_clips.size())
+        m_clips.resize(soundID + 1);
+    vector<int16_t>& clip = m_clips[soundID];
+    clip.resize(frames * MIXER_CHANNELS);
+    for (size_t i = 0; i < frames; i++)
+    {
+        double position = static_cast<double>(i) * sampleRate / MIXER_SAMPLE_RATE;
+        size_t frame = static_cast<size_t>(position);
+        size_t next = min(frame + 1, sourceFrames - 1);
+        double t = position - frame;
+        for (unsigned int c = 0; c < MIXER_CHANNELS; c++)
+            clip[i * MIXER_CHANNELS + c] = static_cast<int16_t>(sample(frame, c) * (1 - t) + sample(next, c) * t);
+    }
+    return true;
+}
+
+void AudioMixer::start(unique_ptr<AudioSink> sink)
+{
+    stop();
+    m_sink = move(sink);
+    m_running = true;
+    m_thread = thread(&AudioMixer::mixLoop, this);
+}
+
+void AudioMixer::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_running = false;
+    m_thread.join();
+    m_sink.reset();
+}
+
+size_t AudioMixer::sampleBytes() const
+{
+    size_t bytes = 0;
+    for (const vector<int16_t>& clip : m_clips)
+        bytes += clip.size() * sizeof(int16_t);
+    return bytes;
+}
+
+void AudioMixer::play(int soundID)
+{
+    if (soundID != SOUND_NONE  &&
+        (soundID < 0  ||  static_cast<size_t>(soundID) >= m_clips.size()  ||  m_clips[soundID].empty()))
+        return;
+
+    while (m_pushLock.test_and_set(memory_order_acquire))
+        ;
+    m_commands.push(soundID);     // a full queue just drops the sound
+    m_pushLock.clear(memory_order_release);
+}
+
+void AudioMixer::mixLoop()
+{
+    int32_t mix[FRAMES_PER_BLOCK * MIXER_CHANNELS];
+    int16_t out[FRAMES_PER_BLOCK * MIXER_CHANNELS];
+    while (m_running)
+    {
+        int soundID;
+        while (m_commands.pop(soundID))
+        {
+            if (soundID == SOUND_NONE)
+            {
+                for (Voice& v : m_voices)
+                    v.clip = nullptr;
+            }
+            else
+                startVoice(soundID);
+        }
+
+        mixBlock(mix, FRAMES_PER_BLOCK);
+        for (size_t i = 0; i < FRAMES_PER_BLOCK * MIXER_CHANNELS; i++)
+            out[i] = static_cast<int16_t>(max(-32768, min(32767, mix[i])));
+        if (!m_sink->write(out, FRAMES_PER_BLOCK))
+            break;
+    }
+}
+
+void AudioMixer::startVoice(int soundID)
+{
+      // Use a free voice if there is one; otherwise steal the one that has
+      // been playing longest.
+    Voice* chosen = &m_voices[0];
+    for (Voice& v : m_voices)
+    {
+        if (v.clip == nullptr)
+        {
+            chosen = &v;
+            break;
+        }
+        if (v.frame > chosen->frame)
+            chosen = &v;
+    }
+    chosen->clip = &m_clips[soundID];
+    chosen->frame = 0;
+}
+
+void AudioMixer::mixBlock(int32_t* mix, size_t frames)
+{
+    fill(mix, mix + frames * MIXER_CHANNELS, 0);
+    int idle = 0;
+    for (Voice& v : m_voices)
+    {
+        if (v.clip == nullptr)
+        {
+            idle++;
+            continue;
+        }
+        size_t clipFrames = v.clip->size() / MIXER_CHANNELS;
+        size_t count = min(frames, clipFrames - v.frame);
+        const int16_t* src = v.clip->data() + v.frame * MIXER_CHANNELS;
+        for (size_t i = 0; i < count * MIXER_CHANNELS; i++)
+            mix[i] += src[i];
+        v.frame += count;
+        if (v.frame == clipFrames)
+        {
+            v.clip = nullptr;
+            idle++;
+        }
+    }
+    m_freeVoices.store(idle, memory_order_relaxed);
+}
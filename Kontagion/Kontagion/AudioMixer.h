@@ -0,0 +1,85 @@
+#ifndef AUDIOMIXER_H_
+#define AUDIOMIXER_H_
+
+#include "AudioSink.h"
+#include "AssetPack.h"
+#include "SpscRing.h"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+const int MAX_MIXER_VOICES = 16;
+
+  // Software mixer.  Every clip is decoded and converted to the sink's format
+  // once, before the mixer starts; after that, playing a sound just queues a
+  // command for the mixer thread, so it never allocates, blocks or touches
+  // the file system.
+
+class AudioMixer
+{
+  public:
+    AudioMixer();
+    ~AudioMixer();
+
+      // The following should be used only before start
+
+    bool loadSound(int soundID, const DecodedSound& sound);
+    bool loadSound(int soundID, const PackedSound& sound);
+
+    void start(std::unique_ptr<AudioSink> sink);
+    void stop();
+    bool isRunning() const
+    {
+        return m_thread.joinable();
+    }
+
+      // Start soundID playing; SOUND_NONE stops everything that is playing.
+      // Safe to call from any thread.
+    void play(int soundID);
+
+      // Voices not playing anything as of the last block mixed; starting
+      // more sounds than this steals voices.  Safe to call from any thread.
+    int freeVoices() const
+    {
+        return m_freeVoices.load(std::memory_order_relaxed);
+    }
+
+      // Memory held by the decoded clips
+    std::size_t sampleBytes() const;
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+  private:
+    struct Voice
+    {
+        const std::vector<int16_t>* clip;   // nullptr if the voice is free
+        std::size_t                 frame;
+    };
+
+    static const std::size_t FRAMES_PER_BLOCK = 512;
+
+    std::vector<std::vector<int16_t>> m_clips;     // indexed by sound ID
+    std::unique_ptr<AudioSink>        m_sink;
+    std::thread                       m_thread;
+    std::atomic<bool>                 m_running;
+
+      // Both the GLUT thread and the simulation thread play sounds, so
+      // pushes are serialized by a spin lock; it is never held for more
+      // than a few instructions.
+    SpscRing<int, 64> m_commands;
+    std::atomic_flag  m_pushLock;
+
+    Voice m_voices[MAX_MIXER_VOICES];       // used only by the mixer thread
+    std::atomic<int> m_freeVoices;
+
+    bool loadSound(int soundID, const unsigned char* samples, std::size_t bytes,
+                   unsigned int sampleRate, unsigned int channels, unsigned int bitsPerSample);
+    void mixLoop();
+    void startVoice(int soundID);
+    void mixBlock(int32_t* mix, std::size_t frames);
+};
+
+#endif // AUDIOMIXER_H_
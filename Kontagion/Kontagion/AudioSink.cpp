@@ -0,0 +1,160 @@
+#include "AudioSink.h"
+#include <thread>
+#include <iostream>
+#ifdef KONTAGION_ALSA
+#include <alsa/asoundlib.h>
+#endif
+using namespace std;
+
+NullAudioSink::NullAudioSink()
+ : m_nextWrite(chrono::steady_clock::now())
+{
+}
+
+bool NullAudioSink::write(const int16_t*, size_t frameCount)
+{
+    m_nextWrite += chrono::microseconds(frameCount * 1000000 / MIXER_SAMPLE_RATE);
+    this_thread::sleep_until(m_nextWrite);
+    return true;
+}
+
+static void writeLE(ofstream& out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+WavFileAudioSink::WavFileAudioSink(const string& path)
+ : m_out(path, ios::out|ios::binary|ios::trunc), m_dataBytes(0)
+{
+    if (m_out)
+        writeHeader();
+}
+
+WavFileAudioSink::~WavFileAudioSink()
+{
+    if (m_out)
+    {
+        m_out.seekp(0);
+        writeHeader();      // now with the real sizes
+    }
+}
+
+bool WavFileAudioSink::isOpen() const
+{
+    return m_out.is_open();
+}
+
+bool WavFileAudioSink::write(const int16_t* frames, size_t frameCount)
+{
+    for (size_t i = 0; i < frameCount * MIXER_CHANNELS; i++)
+        writeLE(m_out, static_cast<uint16_t>(frames[i]), 2);
+    m_dataBytes += frameCount * MIXER_CHANNELS * 2;
+    m_pacer.write(frames, frameCount);
+    return m_out.good();
+}
+
+void WavFileAudioSink::writeHeader()
+{
+    uint32_t bytesPerFrame = MIXER_CHANNELS * 2;
+    m_out.write("RIFF", 4);
+    writeLE(m_out, static_cast<uint32_t>(36 + m_dataBytes), 4);
+    m_out.write("WAVEfmt ", 8);
+    writeLE(m_out, 16, 4);
+    writeLE(m_out, 1, 2);       // PCM
+    writeLE(m_out, MIXER_CHANNELS, 2);
+    writeLE(m_out, MIXER_SAMPLE_RATE, 4);
+    writeLE(m_out, MIXER_SAMPLE_RATE * bytesPerFrame, 4);
+    writeLE(m_out, bytesPerFrame, 2);
+    writeLE(m_out, 16, 2);
+    m_out.write("data", 4);
+    writeLE(m_out, static_cast<uint32_t>(m_dataBytes), 4);
+}
+
+#ifdef KONTAGION_ALSA
+
+AlsaAudioSink::AlsaAudioSink()
+ : m_pcm(nullptr)
+{
+    if (snd_pcm_open(&m_pcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0)
+    {
+        m_pcm = nullptr;
+        return;
+    }
+      // Allow 50ms of buffering: enough to ride out scheduling hiccups
+      // without making effects noticeably late.
+    if (snd_pcm_set_params(m_pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           MIXER_CHANNELS, MIXER_SAMPLE_RATE, 1, 50000) < 0)
+    {
+        snd_pcm_close(m_pcm);
+        m_pcm = nullptr;
+    }
+}
+
+AlsaAudioSink::~AlsaAudioSink()
+{
+    if (m_pcm != nullptr)
+    {
+        snd_pcm_drain(m_pcm);
+        snd_pcm_close(m_pcm);
+    }
+}
+
+bool AlsaAudioSink::isOpen() const
+{
+    return m_pcm != nullptr;
+}
+
+bool AlsaAudioSink::write(const int16_t* frames, size_t frameCount)
+{
+    while (frameCount > 0)
+    {
+        snd_pcm_sframes_t written = snd_pcm_writei(m_pcm, frames, frameCount);
+        if (written < 0)
+        {
+              // Recover from underruns and suspends; give up on anything else
+            if (snd_pcm_recover(m_pcm, static_cast<int>(written), 1) < 0)
+                return false;
+            continue;
+        }
+        frames += written * MIXER_CHANNELS;
+        frameCount -= written;
+    }
+    return true;
+}
+
+#endif // KONTAGION_ALSA
+
+unique_ptr<AudioSink> makeAudioSink(const string& description)
+{
+    if (description == "null")
+        return unique_ptr<AudioSink>(new NullAudioSink);
+
+    if (description.compare(0, 4, "wav:") == 0)
+    {
+        unique_ptr<WavFileAudioSink> sink(new WavFileAudioSink(description.substr(4)));
+        if (!sink->isOpen())
+        {
+            cout << "Cannot write audio to " << description.substr(4) << endl;
+            return nullptr;
+        }
+        return unique_ptr<AudioSink>(sink.release());
+    }
+
+#ifdef KONTAGION_ALSA
+    if (description.empty()  ||  description == "alsa")
+    {
+        unique_ptr<AlsaAudioSink> sink(new AlsaAudioSink);
+        if (!sink->isOpen())
+        {
+            cout << "Cannot open ALSA output!  Game will be silent." << endl;
+            return nullptr;
+        }
+        return unique_ptr<AudioSink>(sink.release());
+    }
+#endif
+
+    if (!description.empty())
+        cout << "Unknown audio output " << description << endl;
+    return nullptr;
+}
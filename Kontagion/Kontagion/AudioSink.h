@@ -0,0 +1,78 @@
+#ifndef AUDIOSINK_H_
+#define AUDIOSINK_H_
+
+#include <string>
+#include <fstream>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+  // Everything the mixer produces is interleaved 16-bit stereo at this rate
+const unsigned int MIXER_SAMPLE_RATE = 44100;
+const unsigned int MIXER_CHANNELS = 2;
+
+  // Where the mixer thread sends its output.  write is called only from the
+  // mixer thread, and is expected to block for roughly as long as the frames
+  // take to play, which is what paces the mixer.
+
+class AudioSink
+{
+  public:
+    virtual ~AudioSink() {}
+    virtual bool write(const int16_t* frames, std::size_t frameCount) = 0;
+};
+
+  // Discards everything, but still plays in real time
+class NullAudioSink : public AudioSink
+{
+  public:
+    NullAudioSink();
+    virtual bool write(const int16_t* frames, std::size_t frameCount);
+
+  private:
+    std::chrono::steady_clock::time_point m_nextWrite;
+};
+
+  // Records the mix to a WAV file, in real time, so it can be checked by ear
+  // or by diffing against a known-good recording.
+class WavFileAudioSink : public AudioSink
+{
+  public:
+    WavFileAudioSink(const std::string& path);
+    ~WavFileAudioSink();
+    bool isOpen() const;
+    virtual bool write(const int16_t* frames, std::size_t frameCount);
+
+  private:
+    std::ofstream m_out;
+    std::size_t   m_dataBytes;
+    NullAudioSink m_pacer;
+
+    void writeHeader();
+};
+
+#ifdef KONTAGION_ALSA
+
+typedef struct _snd_pcm snd_pcm_t;
+
+class AlsaAudioSink : public AudioSink
+{
+  public:
+    AlsaAudioSink();
+    ~AlsaAudioSink();
+    bool isOpen() const;
+    virtual bool write(const int16_t* frames, std::size_t frameCount);
+
+  private:
+    snd_pcm_t* m_pcm;
+};
+
+#endif // KONTAGION_ALSA
+
+  // Make a sink from a description: "null", "wav:<path>" or "alsa".  An empty
+  // description picks the platform's real output, if the mixer has one.
+  // Returns nullptr if no such sink can be opened.
+std::unique_ptr<AudioSink> makeAudioSink(const std::string& description);
+
+#endif // AUDIOSINK_H_
@@ -0,0 +1,426 @@
+#include "BenchCompare.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+namespace {
+
+  // Just enough JSON to read back what --bench writes
+
+struct JsonValue
+{
+    enum Type { null_value, boolean, number, text, array, object };
+
+    Type                               type = null_value;
+    double                             num = 0;
+    string                             str;
+    vector<JsonValue>                  items;       // array elements
+    vector<pair<string, JsonValue>>    members;     // object members, in file order
+
+    const JsonValue* find(const string& key) const
+    {
+        for (const pair<string, JsonValue>& m : members)
+            if (m.first == key)
+                return &m.second;
+        return nullptr;
+    }
+};
+
+class JsonParser
+{
+  public:
+    JsonParser(const string& text)
+     : m_text(text), m_pos(0)
+    {
+    }
+
+    bool parse(JsonValue& value)
+    {
+        if (!parseValue(value))
+            return false;
+        skipSpace();
+        return m_pos == m_text.size();
+    }
+
+  private:
+    const string& m_text;
+    size_t        m_pos;
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size()  &&  isspace(static_cast<unsigned char>(m_text[m_pos])))
+            m_pos++;
+    }
+
+    bool consume(char c)
+    {
+        skipSpace();
+        if (m_pos < m_text.size()  &&  m_text[m_pos] == c)
+        {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeWord(const char* word)
+    {
+        size_t len = char_traits<char>::length(word);
+        if (m_text.compare(m_pos, len, word) != 0)
+            return false;
+        m_pos += len;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value)
+    {
+        skipSpace();
+        if (m_pos == m_text.size())
+            return false;
+        char c = m_text[m_pos];
+        if (c == '{')
+            return parseObject(value);
+        if (c == '[')
+            return parseArray(value);
+        if (c == '"')
+        {
+            value.type = JsonValue::text;
+            return parseString(value.str);
+        }
+        if (consumeWord("true")  ||  consumeWord("false"))
+        {
+            value.type = JsonValue::boolean;
+            value.num = (c == 't');
+            return true;
+        }
+        if (consumeWord("null"))
+        {
+            value.type = JsonValue::null_value;
+            return true;
+        }
+
+        const char* start = m_text.c_str() + m_pos;
+        char* end;
+        value.num = strtod(start, &end);
+        if (end == start)
+            return false;
+        value.type = JsonValue::number;
+        m_pos += end - start;
+        return true;
+    }
+
+    bool parseString(string& out)
+    {
+        if (!consume('"'))
+            return false;
+        out.clear();
+        while (m_pos < m_text.size())
+        {
+            char c = m_text[m_pos++];
+            if (c == '"')
+                return true;
+            if (c == '\\')
+            {
+                if (m_pos == m_text.size())
+                    return false;
+                c = m_text[m_pos++];
+                switch (c)
+                {
+                    case 'n':  c = '\n';  break;
+                    case 't':  c = '\t';  break;
+                    case 'r':  c = '\r';  break;
+                    case 'b':  c = '\b';  break;
+                    case 'f':  c = '\f';  break;
+                    case 'u':  return false;    // --bench never writes these
+                    default:   break;          // \" \\ and \/ stand for themselves
+                }
+            }
+            out += c;
+        }
+        return false;
+    }
+
+    bool parseArray(JsonValue& value)
+    {
+        value.type = JsonValue::array;
+        consume('[');
+        if (consume(']'))
+            return true;
+        do
+        {
+            value.items.emplace_back();
+            if (!parseValue(value.items.back()))
+                return false;
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parseObject(JsonValue& value)
+    {
+        value.type = JsonValue::object;
+        consume('{');
+        if (consume('}'))
+            return true;
+        do
+        {
+            string key;
+            skipSpace();
+            if (!parseString(key)  ||  !consume(':'))
+                return false;
+            value.members.emplace_back(key, JsonValue());
+            if (!parseValue(value.members.back().second))
+                return false;
+        } while (consume(','));
+        return consume('}');
+    }
+};
+
+bool readJson(const string& path, JsonValue& value)
+{
+    ifstream in(path);
+    if (!in)
+    {
+        cout << "Cannot open " << path << endl;
+        return false;
+    }
+    stringstream contents;
+    contents << in.rdbuf();
+    string text = contents.str();
+    if (!JsonParser(text).parse(value)  ||  value.type != JsonValue::object  ||
+        value.find("scenarios") == nullptr)
+    {
+        cout << path << " is not a benchmark result file" << endl;
+        return false;
+    }
+    return true;
+}
+
+  // A median with a bootstrapped 95% confidence interval
+struct MedianEstimate
+{
+    double median;
+    double low;
+    double high;
+};
+
+double medianOf(vector<double> samples)
+{
+    sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    return n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+}
+
+MedianEstimate estimateMedian(const vector<double>& samples)
+{
+    MedianEstimate estimate;
+    estimate.median = medianOf(samples);
+
+      // Resample with replacement; the spread of the resampled medians
+      // gives the interval.  A fixed seed keeps the gate's verdict stable.
+    const int RESAMPLES = 2000;
+    minstd_rand generator(12345);
+    uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+    vector<double> medians(RESAMPLES);
+    vector<double> resample(samples.size());
+    for (int r = 0; r < RESAMPLES; r++)
+    {
+        for (double& x : resample)
+            x = samples[pick(generator)];
+        medians[r] = medianOf(resample);
+    }
+    sort(medians.begin(), medians.end());
+    estimate.low = medians[RESAMPLES * 25 / 1000];
+    estimate.high = medians[RESAMPLES * 975 / 1000 - 1];
+    return estimate;
+}
+
+struct CompareOptions
+{
+    double threshold = 5;
+    double minNs = 1000;
+};
+
+struct Comparison
+{
+    string         scenario;
+    string         metric;
+    MedianEstimate baseline;
+    MedianEstimate current;
+    double         change;      // percent, positive meaning worse
+    const char*    verdict;
+};
+
+bool samplesOf(const JsonValue& value, vector<double>& samples)
+{
+    samples.clear();
+    if (value.type == JsonValue::number)
+        samples.push_back(value.num);
+    for (const JsonValue& item : value.items)
+        if (item.type == JsonValue::number)
+            samples.push_back(item.num);
+    return !samples.empty();
+}
+
+Comparison compareMetric(const string& scenario, const string& metric, const vector<double>& before,
+                         const vector<double>& after, const CompareOptions& options)
+{
+    Comparison c;
+    c.scenario = scenario;
+    c.metric = metric;
+    c.baseline = estimateMedian(before);
+    c.current = estimateMedian(after);
+
+      // Throughput is better higher; everything else is a cost
+    bool higherIsBetter = (metric == "ticks_per_sec");
+    double base = c.baseline.median;
+    double delta = c.current.median - base;
+    if (higherIsBetter)
+        delta = -delta;
+    if (base != 0)
+        c.change = 100 * delta / fabs(base);
+    else
+        c.change = (delta > 0 ? HUGE_VAL : (delta < 0 ? -HUGE_VAL : 0));
+
+      // Only trust a change once the ranges the two medians could plausibly
+      // have had don't overlap, so the spread of both runs counts
+    bool separated = (c.current.high < c.baseline.low  ||  c.current.low > c.baseline.high);
+    bool isTiming = (metric.size() >= 3  &&  metric.compare(metric.size() - 3, 3, "_ns") == 0)  ||
+                    metric.compare(0, 6, "phase:") == 0;
+    if (isTiming  &&  max(c.baseline.median, c.current.median) < options.minNs)
+        c.verdict = "";
+    else if (separated  &&  c.change > options.threshold)
+        c.verdict = "REGRESSED";
+    else if (separated  &&  c.change < -options.threshold)
+        c.verdict = "improved";
+    else
+        c.verdict = "";
+    return c;
+}
+
+string formatEstimate(const MedianEstimate& e)
+{
+    ostringstream oss;
+    oss << setprecision(4) << e.median << " [" << e.low << ", " << e.high << "]";
+    return oss.str();
+}
+
+string formatChange(double change)
+{
+    ostringstream oss;
+    if (isinf(change))
+        oss << (change > 0 ? "worse" : "better") << " than 0";
+    else
+        oss << showpos << fixed << setprecision(1) << change << "%";
+    return oss.str();
+}
+
+bool parseOptions(int argc, char* argv[], CompareOptions& options, string& baseline, string& current)
+{
+    vector<string> files;
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--threshold"  &&  i + 1 < argc)
+            options.threshold = atof(argv[++i]);
+        else if (arg == "--min-ns"  &&  i + 1 < argc)
+            options.minNs = atof(argv[++i]);
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            cout << "Unknown or incomplete option " << arg << endl;
+            return false;
+        }
+        else
+            files.push_back(arg);
+    }
+    if (files.size() != 2)
+    {
+        cout << "usage: Kontagion --bench-compare BASELINE.json CURRENT.json "
+                "[--threshold PCT] [--min-ns N]" << endl;
+        return false;
+    }
+    baseline = files[0];
+    current = files[1];
+    return true;
+}
+
+}  // namespace
+
+int compareBenchmarks(int argc, char* argv[])
+{
+    CompareOptions options;
+    string baselinePath, currentPath;
+    if (!parseOptions(argc, argv, options, baselinePath, currentPath))
+        return 2;
+
+    JsonValue baseline, current;
+    if (!readJson(baselinePath, baseline)  ||  !readJson(currentPath, current))
+        return 2;
+
+    vector<Comparison> rows;
+    vector<double> before, after;
+    for (const JsonValue& scenario : baseline.find("scenarios")->items)
+    {
+        const JsonValue* name = scenario.find("name");
+        if (name == nullptr)
+            continue;
+        const JsonValue* match = nullptr;
+        for (const JsonValue& s : current.find("scenarios")->items)
+        {
+            const JsonValue* n = s.find("name");
+            if (n != nullptr  &&  n->str == name->str)
+                match = &s;
+        }
+        if (match == nullptr)
+        {
+            cout << "Note: scenario " << name->str << " is missing from " << currentPath << endl;
+            continue;
+        }
+
+          // Compare the headline metrics, then each phase of the tick
+        const char* const groups[] = { "metrics", "phases_ns_per_tick", "counters_per_tick" };
+        for (const char* group : groups)
+        {
+            const JsonValue* was = scenario.find(group);
+            const JsonValue* now = match->find(group);
+            if (was == nullptr  ||  now == nullptr)
+                continue;
+            for (const pair<string, JsonValue>& m : was->members)
+            {
+                const JsonValue* nowMetric = now->find(m.first);
+                if (nowMetric == nullptr  ||  !samplesOf(m.second, before)  ||  !samplesOf(*nowMetric, after))
+                    continue;
+                string metric = (group == groups[1] ? "phase:" + m.first : m.first);
+                rows.push_back(compareMetric(name->str, metric, before, after, options));
+            }
+        }
+    }
+
+    int regressions = 0;
+    cout << left << setw(12) << "scenario" << setw(28) << "metric" << setw(36) << "baseline median [95% CI]"
+         << setw(36) << "current median [95% CI]" << setw(14) << "worse by" << endl;
+    for (const Comparison& c : rows)
+    {
+        cout << left << setw(12) << c.scenario << setw(28) << c.metric << setw(36) << formatEstimate(c.baseline)
+             << setw(36) << formatEstimate(c.current) << setw(14) << formatChange(c.change) << c.verdict << endl;
+        if (string(c.verdict) == "REGRESSED")
+            regressions++;
+    }
+
+    if (regressions > 0)
+    {
+        cout << regressions << " metric" << (regressions == 1 ? "" : "s") << " regressed by more than "
+             << options.threshold << "%" << endl;
+        return 1;
+    }
+    cout << "No regressions beyond " << options.threshold << "%" << endl;
+    return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef BENCHCOMPARE_H_
+#define BENCHCOMPARE_H_
+
+  // Kontagion --bench-compare BASELINE CURRENT [options] compares two files
+  // written by --bench, scenario by scenario, for every metric, every tick
+  // phase and any hardware counters.  A metric regresses when its median
+  // got worse by more than the threshold and the 95% confidence intervals
+  // of the two medians don't overlap, so noise in either run can't fail the
+  // gate on its own.
+  //
+  //   --threshold PCT   allowed slowdown in percent (default 5)
+  //   --min-ns N        ignore timings whose medians are both under N ns
+  //                     (default 1000); they are mostly timer noise
+  //
+  // argc and argv cover only the arguments after --bench-compare.  Returns 0
+  // if nothing regressed, 1 if something did, and 2 if the files couldn't be
+  // read.
+
+int compareBenchmarks(int argc, char* argv[]);
+
+#endif // BENCHCOMPARE_H_
@@ -0,0 +1,669 @@
+#include "Benchmark.h"
+#include "ActorWorld.h"
+#include "Actor.h"
+#include "AllocCounter.h"
+#include "PerfCounters.h"
+#include "LatencyHistogram.h"
+#include "HeuristicBot.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <utility>
+using namespace std;
+
+namespace {
+
+struct BenchOptions
+{
+    int         ticks = 1000;
+    int         warmup = 100;
+    int         repeats = 10;
+    unsigned    seed = 1;
+    int         queryCalls = 2000;
+    bool        counters = false;
+    bool        list = false;           // just name the scenarios
+    double      watchdogMs = 0;     // slow-tick dumps are off unless asked for
+    string      scenario;
+    string      outPath = "kontagion-bench.json";
+};
+
+  // The dish a scenario starts from: the level to init, then any extra setup
+struct Scenario
+{
+    const char* name;
+    const char* description;
+    int         level;
+    void      (*setup)(ActorWorld& world);
+    bool        flameSpam;      // Socrates throws a full ring of flames every tick
+    bool        autopilot;      // the HeuristicBot plays Socrates
+};
+
+void addBacteria(ActorWorld& world, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        double x, y;
+        world.generateRandPos(x, y);
+        switch (i % 3)
+        {
+            case 0:  world.spawnRegSal(x, y);  break;
+            case 1:  world.spawnAggSal(x, y);  break;
+            default: world.spawnEColi(x, y);   break;
+        }
+    }
+}
+
+void setupEmptyDish(ActorWorld& world)
+{
+    world.clearActors();
+}
+
+void setupLevelDefault(ActorWorld&)
+{
+}
+
+void setupCrowded(ActorWorld& world)
+{
+    world.clearActors();
+    for (int i = 0; i < 180; i++)
+    {
+        double x, y;
+        world.generateRandPos(x, y);
+        world.addDirt(x, y);
+    }
+    addBacteria(world, 500);
+}
+
+void setupFlameSpam(ActorWorld& world)
+{
+    addBacteria(world, 100);
+}
+
+void setupDivision(ActorWorld& world)
+{
+      // Plenty of food and nothing to stop them eating it, so the bacteria
+      // keep dividing
+    world.clearActors();
+    for (int i = 0; i < 400; i++)
+    {
+        double x, y;
+        world.generateRandPos(x, y);
+        world.addFood(x, y);
+    }
+    for (int i = 0; i < 50; i++)
+    {
+        double x, y;
+        world.generateRandPos(x, y);
+        world.spawnRegSal(x, y);
+    }
+}
+
+const Scenario SCENARIOS[] = {
+    { "empty-dish", "Socrates alone; the fixed cost of a tick", 1, setupEmptyDish, false, false },
+    { "level-1", "the level 1 dish as init() builds it", 1, setupLevelDefault, false, false },
+    { "level-10", "the level 10 dish as init() builds it", 10, setupLevelDefault, false, false },
+    { "crowded", "500 bacteria and 180 dirt", 1, setupCrowded, false, false },
+    { "flame-spam", "level 1 plus 100 bacteria, 16 flames thrown every tick", 1, setupFlameSpam, true, false },
+    { "division", "50 salmonella among 400 food", 1, setupDivision, false, false },
+    { "autopilot", "level 10 played by the heuristic bot: spraying, flames and goodies", 10, setupLevelDefault, false, true },
+};
+
+  // With a bot playing, the dish can be cleared before the run is over;
+  // it is then built again, as after a death
+bool dishFinished(const Scenario& scenario, int status)
+{
+    return status == GWSTATUS_PLAYER_DIED  ||  (scenario.autopilot  &&  status == GWSTATUS_FINISHED_LEVEL);
+}
+
+  // Everything measured in one repeat of one scenario
+struct RepeatResult
+{
+    double ticksPerSec;
+    double tickP99Ns;       // 99th percentile of the time a tick took
+    double allocsPerTick;
+    double blockedNs;       // per bacteriaMovementBlocked call
+    double findFoodNs;      // per findFood call
+    double flameDamageNs;   // per flameDamage call
+    int    finalActors;
+    int    socratesDeaths;
+    long long phaseNs[NUM_TICK_PHASES];
+    double counters[NUM_TICK_PHASES][NUM_PERF_COUNTERS];   // per tick, if measured
+};
+
+  // Reads the hardware counters at every phase boundary and charges the
+  // difference to the phase that just ended
+struct CounterAttribution
+{
+    PerfCounters* counters;
+    bool          timed;
+    CounterSample last;
+    unsigned long long totals[NUM_TICK_PHASES][NUM_PERF_COUNTERS];
+};
+
+void attributeCounters(int endedPhase, void* context)
+{
+    CounterAttribution& a = *static_cast<CounterAttribution*>(context);
+    CounterSample now;
+    a.counters->read(now);
+    if (endedPhase >= 0  &&  a.timed)
+    {
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            a.totals[endedPhase][c] += now.values[c] - a.last.values[c];
+    }
+    a.last = now;
+}
+
+void buildWorld(ActorWorld& world, const Scenario& scenario, unsigned seed)
+{
+    seedRandInt(seed);
+    world.init();
+    scenario.setup(world);
+}
+
+double nsPerCall(chrono::steady_clock::time_point start, int calls)
+{
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / calls;
+}
+
+  // Time each query on its own against the dish as the run left it
+void timeQueries(ActorWorld& world, const BenchOptions& options, RepeatResult& result)
+{
+      // Positions are drawn up front so randInt isn't part of the timing
+    vector<double> xs(options.queryCalls), ys(options.queryCalls);
+    for (int i = 0; i < options.queryCalls; i++)
+        world.generateRandPos(xs[i], ys[i]);
+
+    int hits = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < options.queryCalls; i++)
+        hits += world.bacteriaMovementBlocked(xs[i], ys[i]);
+    result.blockedNs = nsPerCall(start, options.queryCalls);
+
+    RegularSalmonella probe(&world, xs[0], ys[0]);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < options.queryCalls; i++)
+    {
+        double foodX, foodY;
+        probe.moveTo(xs[i], ys[i]);
+        hits += world.findFood(&probe, foodX, foodY);
+    }
+    result.findFoodNs = nsPerCall(start, options.queryCalls);
+
+      // A flame that can't hit anything is the worst case (it checks every
+      // actor), and it leaves the dish untouched
+    Flame flame(&world, -VIEW_WIDTH, -VIEW_HEIGHT, 0);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < options.queryCalls; i++)
+        world.flameDamage(&flame);
+    result.flameDamageNs = nsPerCall(start, options.queryCalls);
+
+    volatile int sink = hits;   // keep the calls from being optimized away
+    (void)sink;
+}
+
+RepeatResult runRepeat(const Scenario& scenario, const BenchOptions& options, PerfCounters& counters)
+{
+    RepeatResult result = RepeatResult();
+    ActorWorld world("");
+    world.reportMemoryTo(nullptr);
+    world.watchdog().configure(options.watchdogMs, 32);
+    CounterAttribution attribution = CounterAttribution();
+    attribution.counters = &counters;
+    if (counters.isOpen())
+        world.observeTickPhases(attributeCounters, &attribution);
+    HeuristicBot bot;
+    if (scenario.autopilot)
+        world.setInputPolicy(&bot);
+    for (int level = 1; level < scenario.level; level++)
+        world.advanceToNextLevel();
+    buildWorld(world, scenario, options.seed);
+
+    long long tickNs = 0;
+    LatencyHistogram tickTimes;
+    unsigned long long allocs = 0;
+    for (int t = -options.warmup; t < options.ticks; t++)
+    {
+        bool timed = (t >= 0);
+        attribution.timed = timed;
+        unsigned long long allocsBefore = allocationCount();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+          // Keep Socrates alive so every scenario runs its full length
+        world.restoreSocrates();
+        if (scenario.flameSpam)
+            world.throwFlames();
+        int status = world.move();
+        world.flushSounds();
+
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        if (timed)
+        {
+            long long ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+            tickNs += ns;
+            tickTimes.record(ns);
+            allocs += allocationCount() - allocsBefore;
+            const TickProfile& profile = world.lastTickProfile();
+            for (int p = 0; p < NUM_TICK_PHASES; p++)
+                result.phaseNs[p] += profile.phases[p].ns;
+        }
+
+        if (dishFinished(scenario, status))
+        {
+              // Overwhelmed within a single tick (or, for the bot, done);
+              // start the dish again
+            result.socratesDeaths++;
+            world.cleanUp();
+            buildWorld(world, scenario, options.seed + result.socratesDeaths);
+        }
+    }
+
+    result.ticksPerSec = options.ticks / (tickNs / 1e9);
+    result.tickP99Ns = static_cast<double>(tickTimes.percentile(.99));
+    result.allocsPerTick = static_cast<double>(allocs) / options.ticks;
+    for (int p = 0; p < NUM_TICK_PHASES; p++)
+    {
+        result.phaseNs[p] /= options.ticks;
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            result.counters[p][c] = static_cast<double>(attribution.totals[p][c]) / options.ticks;
+    }
+    result.finalActors = world.actorCount();
+    timeQueries(world, options, result);
+    return result;
+}
+
+void writeSamples(ostream& out, const char* name, const vector<RepeatResult>& results,
+                  double RepeatResult::*field, bool last = false)
+{
+    out << "        \"" << name << "\": [";
+    for (size_t i = 0; i < results.size(); i++)
+        out << (i == 0 ? "" : ", ") << results[i].*field;
+    out << "]" << (last ? "" : ",") << "\n";
+}
+
+void writeScenario(ostream& out, const Scenario& scenario, const vector<RepeatResult>& results,
+                   const PerfCounters& counters, bool last)
+{
+    out << "    {\n";
+    out << "      \"name\": \"" << scenario.name << "\",\n";
+    out << "      \"description\": \"" << scenario.description << "\",\n";
+    out << "      \"metrics\": {\n";
+    writeSamples(out, "ticks_per_sec", results, &RepeatResult::ticksPerSec);
+    writeSamples(out, "tick_p99_ns", results, &RepeatResult::tickP99Ns);
+    writeSamples(out, "allocs_per_tick", results, &RepeatResult::allocsPerTick);
+    writeSamples(out, "bacteriaMovementBlocked_ns", results, &RepeatResult::blockedNs);
+    writeSamples(out, "findFood_ns", results, &RepeatResult::findFoodNs);
+    writeSamples(out, "flameDamage_ns", results, &RepeatResult::flameDamageNs, true);
+    out << "      },\n";
+
+    out << "      \"phases_ns_per_tick\": {\n";
+    for (int p = 0; p < NUM_TICK_PHASES; p++)
+    {
+        out << "        \"" << tickPhaseName(static_cast<TickPhase>(p)) << "\": [";
+        for (size_t i = 0; i < results.size(); i++)
+            out << (i == 0 ? "" : ", ") << results[i].phaseNs[p];
+        out << "]" << (p + 1 == NUM_TICK_PHASES ? "" : ",") << "\n";
+    }
+    out << "      },\n";
+
+    if (counters.isOpen())
+    {
+        bool first = true;
+        out << "      \"counters_per_tick\": {\n";
+        for (int p = 0; p < NUM_TICK_PHASES; p++)
+        {
+            for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            {
+                if (!counters.has(static_cast<PerfCounterID>(c)))
+                    continue;
+                out << (first ? "" : ",\n") << "        \"" << tickPhaseName(static_cast<TickPhase>(p))
+                    << "." << perfCounterName(static_cast<PerfCounterID>(c)) << "\": [";
+                for (size_t i = 0; i < results.size(); i++)
+                    out << (i == 0 ? "" : ", ") << results[i].counters[p][c];
+                out << "]";
+                first = false;
+            }
+        }
+        out << "\n      },\n";
+    }
+
+    int deaths = 0;
+    out << "      \"final_actors\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        out << (i == 0 ? "" : ", ") << results[i].finalActors;
+        deaths += results[i].socratesDeaths;
+    }
+    out << "],\n";
+    out << "      \"socrates_deaths\": " << deaths << "\n";
+    out << "    }" << (last ? "" : ",") << "\n";
+}
+
+void printCounters(const RepeatResult& result, const PerfCounters& counters)
+{
+    for (int p = 0; p < NUM_TICK_PHASES; p++)
+    {
+        const double* c = result.counters[p];
+        cout << "    " << tickPhaseName(static_cast<TickPhase>(p)) << ":";
+        if (counters.has(COUNTER_CYCLES)  &&  counters.has(COUNTER_INSTRUCTIONS)  &&  c[COUNTER_CYCLES] > 0)
+            cout << " IPC " << c[COUNTER_INSTRUCTIONS] / c[COUNTER_CYCLES] << ",";
+        for (int id = 0; id < NUM_PERF_COUNTERS; id++)
+            if (counters.has(static_cast<PerfCounterID>(id)))
+                cout << " " << c[id] << " " << perfCounterName(static_cast<PerfCounterID>(id));
+        cout << " per tick" << endl;
+    }
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options)
+{
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--list")
+        {
+            options.list = true;
+            continue;
+        }
+        if (arg == "--counters")
+        {
+            options.counters = true;
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            cout << "Missing value for " << arg << endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--ticks")
+            options.ticks = atoi(value);
+        else if (arg == "--warmup")
+            options.warmup = atoi(value);
+        else if (arg == "--repeats")
+            options.repeats = atoi(value);
+        else if (arg == "--seed")
+            options.seed = static_cast<unsigned>(strtoul(value, nullptr, 10));
+        else if (arg == "--scenario")
+            options.scenario = value;
+        else if (arg == "--out")
+            options.outPath = value;
+        else if (arg == "--watchdog")
+            options.watchdogMs = atof(value);
+        else
+        {
+            cout << "Unknown benchmark option " << arg << endl;
+            return false;
+        }
+    }
+    if (options.ticks <= 0  ||  options.repeats <= 0  ||  options.warmup < 0)
+    {
+        cout << "--ticks and --repeats must be positive" << endl;
+        return false;
+    }
+    return true;
+}
+
+void listScenarios()
+{
+    for (const Scenario& s : SCENARIOS)
+        cout << s.name << ": " << s.description << endl;
+}
+
+  // Where the allocations in one kind of tick came from, merged across ticks
+struct SiteTotals
+{
+    AllocationSite     site;
+    unsigned long long ticks;   // how many ticks hit this site
+};
+typedef map<vector<void*>, SiteTotals> SiteMap;
+
+void mergeSite(const AllocationSite& site, void* context)
+{
+    SiteMap& sites = *static_cast<SiteMap*>(context);
+    SiteTotals& totals = sites[vector<void*>(site.frames, site.frames + site.depth)];
+    if (totals.ticks == 0)
+    {
+        totals.site = site;
+        totals.site.count = 0;
+        totals.site.bytes = 0;
+    }
+    totals.site.count += site.count;
+    totals.site.bytes += site.bytes;
+    totals.ticks++;
+}
+
+void printSites(const SiteMap& sites, size_t limit)
+{
+    vector<const SiteTotals*> sorted;
+    for (const pair<const vector<void*>, SiteTotals>& s : sites)
+        sorted.push_back(&s.second);
+    sort(sorted.begin(), sorted.end(), [](const SiteTotals* a, const SiteTotals* b) {
+        return a->site.count > b->site.count;
+    });
+    for (size_t i = 0; i < sorted.size()  &&  i < limit; i++)
+    {
+        const SiteTotals& s = *sorted[i];
+        cout << "  " << s.site.count << " allocations (" << s.site.bytes << " bytes) in " << s.ticks
+             << " ticks from\n" << describeAllocationSite(s.site, "      ");
+    }
+    if (sorted.size() > limit)
+        cout << "  ... and " << sorted.size() - limit << " more sites" << endl;
+}
+
+  // How one scenario's ticks split between steady state and spawning
+struct AllocTally
+{
+    int                steadyTicks;
+    int                steadyTicksAllocating;
+    unsigned long long steadyAllocations;
+    int                spawnTicks;
+    unsigned long long spawnAllocations;
+};
+
+AllocTally checkScenario(const Scenario& scenario, const BenchOptions& options, SiteMap& steadySites,
+                         SiteMap& spawnSites)
+{
+    AllocTally tally = AllocTally();
+    ActorWorld world("");
+    world.reportMemoryTo(nullptr);
+    world.watchdog().configure(0, 1);
+    HeuristicBot bot;
+    if (scenario.autopilot)
+        world.setInputPolicy(&bot);
+    for (int level = 1; level < scenario.level; level++)
+        world.advanceToNextLevel();
+    buildWorld(world, scenario, options.seed);
+    int deaths = 0;
+
+    for (int t = -options.warmup; t < options.ticks; t++)
+    {
+        world.restoreSocrates();
+        if (scenario.flameSpam)
+            world.throwFlames();
+
+          // Only what move() itself does counts
+        bool timed = (t >= 0);
+        long long createdBefore = world.actorsCreated();
+        unsigned long long allocsBefore = allocationCount();
+        trackAllocationSites(timed);
+        int status = world.move();
+        trackAllocationSites(false);
+        unsigned long long allocs = allocationCount() - allocsBefore;
+        bool spawned = (world.actorsCreated() != createdBefore);
+
+        if (timed  &&  spawned)
+        {
+            tally.spawnTicks++;
+            tally.spawnAllocations += allocs;
+            drainAllocationSites(mergeSite, &spawnSites);
+        }
+        else if (timed)
+        {
+            tally.steadyTicks++;
+            tally.steadyAllocations += allocs;
+            if (allocs > 0)
+                tally.steadyTicksAllocating++;
+            drainAllocationSites(mergeSite, &steadySites);
+        }
+        world.flushSounds();
+
+        if (dishFinished(scenario, status))
+        {
+            deaths++;
+            world.cleanUp();
+            buildWorld(world, scenario, options.seed + deaths);
+        }
+    }
+    return tally;
+}
+
+}  // namespace
+
+int verifyZeroAllocations(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    if (options.list)
+    {
+        listScenarios();
+        return 0;
+    }
+
+    SiteMap steadySites, spawnSites;
+    unsigned long long steadyAllocations = 0;
+    bool anyScenario = false;
+    for (const Scenario& scenario : SCENARIOS)
+    {
+        if (!options.scenario.empty()  &&  options.scenario != scenario.name)
+            continue;
+        anyScenario = true;
+        AllocTally tally = checkScenario(scenario, options, steadySites, spawnSites);
+        steadyAllocations += tally.steadyAllocations;
+        cout << scenario.name << ": " << tally.steadyTicks << " steady ticks, "
+             << tally.steadyTicksAllocating << " of them allocating (" << tally.steadyAllocations
+             << " allocations); " << tally.spawnTicks << " ticks spawned actors ("
+             << tally.spawnAllocations << " allocations)" << endl;
+    }
+    if (!anyScenario)
+    {
+        cout << "No scenario called " << options.scenario << " (try --list)" << endl;
+        return 1;
+    }
+
+    if (allocationSitesTracked())
+    {
+        if (!steadySites.empty())
+        {
+            cout << "Allocations in steady-state ticks:" << endl;
+            printSites(steadySites, 20);
+        }
+        if (!spawnSites.empty())
+        {
+            cout << "Allocations in ticks that spawned actors:" << endl;
+            printSites(spawnSites, 10);
+        }
+        if (untrackedAllocations() > 0)
+            cout << untrackedAllocations() << " allocations weren't attributed (site table full)" << endl;
+    }
+    else if (steadyAllocations > 0)
+        cout << "Build with KONTAGION_ALLOC_TRACKING defined to see where they come from" << endl;
+
+    if (steadyAllocations > 0)
+    {
+        cout << "FAILED: steady-state ticks allocated " << steadyAllocations << " times" << endl;
+        return 1;
+    }
+    cout << "OK: no steady-state tick allocated" << endl;
+    return 0;
+}
+
+int runBenchmarks(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    if (options.list)
+    {
+        listScenarios();
+        return 0;
+    }
+
+    vector<const Scenario*> chosen;
+    for (const Scenario& s : SCENARIOS)
+        if (options.scenario.empty()  ||  options.scenario == s.name)
+            chosen.push_back(&s);
+    if (chosen.empty())
+    {
+        cout << "No scenario called " << options.scenario << " (try --list)" << endl;
+        return 1;
+    }
+
+    PerfCounters counters;
+    if (options.counters)
+    {
+        string whyNot;
+        if (!counters.open(whyNot))
+            cout << "Hardware counters unavailable, timing only: " << whyNot << endl;
+    }
+
+    ofstream out(options.outPath);
+    if (!out)
+    {
+        cout << "Cannot write " << options.outPath << endl;
+        return 1;
+    }
+    out.precision(8);
+    out << "{\n";
+    out << "  \"benchmark\": \"kontagion-sim\",\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"seed\": " << options.seed << ",\n";
+    out << "  \"ticks\": " << options.ticks << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"repeats\": " << options.repeats << ",\n";
+    out << "  \"scenarios\": [\n";
+
+      // Take the scenarios in turn on each repeat, rather than each one's
+      // repeats back to back, so a stretch where the machine runs slow
+      // spreads over every scenario's samples and widens their intervals
+      // instead of shifting one scenario's median
+    vector<vector<RepeatResult>> allResults(chosen.size());
+    for (int r = 0; r < options.repeats; r++)
+        for (size_t i = 0; i < chosen.size(); i++)
+            allResults[i].push_back(runRepeat(*chosen[i], options, counters));
+
+    for (size_t i = 0; i < chosen.size(); i++)
+    {
+        const Scenario& scenario = *chosen[i];
+        const vector<RepeatResult>& results = allResults[i];
+
+        double best = 0;
+        for (const RepeatResult& result : results)
+            best = max(best, result.ticksPerSec);
+        cout << scenario.name << ": best " << best << " ticks/s, p99 tick "
+             << results.back().tickP99Ns / 1e6 << " ms, "
+             << results.back().allocsPerTick << " allocs/tick, queries "
+             << results.back().blockedNs << " / " << results.back().findFoodNs << " / "
+             << results.back().flameDamageNs << " ns (blocked / findFood / flameDamage)" << endl;
+        if (counters.isOpen())
+            printCounters(results.back(), counters);
+        writeScenario(out, scenario, results, counters, i + 1 == chosen.size());
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+    if (!out)
+    {
+        cout << "Cannot write " << options.outPath << endl;
+        return 1;
+    }
+    cout << "Wrote " << options.outPath << endl;
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+  // Kontagion --bench [options] runs the simulation core headless through a
+  // set of fixed, seeded scenarios and writes the results as JSON:
+  //
+  //   --scenario NAME   run only this scenario (--list shows them)
+  //   --ticks N         timed ticks per repeat (default 1000)
+  //   --warmup N        untimed ticks before timing starts (default 100)
+  //   --repeats N       independent runs of each scenario (default 10)
+  //   --seed N          randInt seed; the same seed gives the same dish
+  //   --out FILE        where to write the JSON (default kontagion-bench.json)
+  //   --counters        also read hardware performance counters (Linux),
+  //                     attributed to each phase of the tick
+  //   --watchdog MS     dump the recent ticks whenever one takes longer than
+  //                     MS (off by default)
+  //
+  // argc and argv cover only the arguments after --bench.  Returns the exit
+  // status.
+
+int runBenchmarks(int argc, char* argv[]);
+
+  // Kontagion --verify-zero-alloc [--scenario NAME] [--ticks N] [--warmup N]
+  // [--seed N] runs the same scenarios and checks that every tick in which
+  // no actor was created finished without touching the heap.  Ticks that
+  // did create actors are reported but allowed to allocate.  Built with
+  // KONTAGION_ALLOC_TRACKING, it also lists the call stacks that allocated.
+  // Returns 0 if the steady-state ticks were allocation-free, else 1.
+
+int verifyZeroAllocations(int argc, char* argv[]);
+
+#endif // BENCHMARK_H_
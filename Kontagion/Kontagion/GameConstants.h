@@ -3,6 +3,7 @@
 
 #include <random>
 #include <utility>
+#include <cstdint>
 
 // image IDs for the game objects
 
@@ -62,6 +63,15 @@ const double SPRITE_WIDTH_GL = .3; // note - this is tied implicitly to SPRITE_W
 const double SPRITE_HEIGHT_GL = .25; // note - this is tied implicitly to SPRITE_HEIGHT due to carey's sloppy openGL programming
 
 
+// simulation cadence.  Frames drawn in between ticks interpolate actor
+// positions, so this can be raised without the motion getting choppy.
+
+const int MS_PER_TICK = 15;
+
+// longest status line, including its terminating '\0'
+
+const int MAX_STATUS_TEXT = 128;
+
 // status of each tick (did the player die?)
 
 const int GWSTATUS_PLAYER_DIED    = 0;
@@ -71,6 +81,93 @@ const int GWSTATUS_FINISHED_LEVEL = 3;
 const int GWSTATUS_LEVEL_ERROR    = 4;
 
 
+  // A Mersenne Twister that also keeps its seed and how many numbers it has
+  // given out.  Those two say where it is in its sequence, so comparing them
+  // is as good as comparing its 2.5 KB of state, and much cheaper.
+
+class RandSequence
+{
+  public:
+    explicit RandSequence(unsigned int seed = std::mt19937::default_seed)
+     : m_engine(seed), m_seed(seed), m_draws(0)
+    {}
+
+    void seed(unsigned int seed)
+    {
+        m_engine.seed(seed);
+        m_seed = seed;
+        m_draws = 0;
+    }
+
+    std::uint32_t operator()()
+    {
+        m_draws++;
+        return static_cast<std::uint32_t>(m_engine());
+    }
+
+    unsigned int startSeed() const
+    {
+        return m_seed;
+    }
+
+    std::uint64_t draws() const
+    {
+        return m_draws;
+    }
+
+  private:
+    std::mt19937  m_engine;
+    unsigned int  m_seed;
+    std::uint64_t m_draws;
+};
+
+  // The generator behind randInt.  Each thread draws from its own, since the
+  // simulation and the renderer run on different threads.  It starts from a
+  // random seed unless seedRandInt is called.  A thread may instead draw from
+  // a generator of its choosing for a while (useRandEngine), so a world that
+  // is stepped from several threads keeps a sequence of its own.
+
+inline
+RandSequence& threadRandEngine()
+{
+    static thread_local std::random_device rd;
+    static thread_local RandSequence generator(rd());
+    return generator;
+}
+
+inline
+RandSequence*& borrowedRandEngine()
+{
+    static thread_local RandSequence* borrowed = nullptr;
+    return borrowed;
+}
+
+inline
+RandSequence& randEngine()
+{
+    RandSequence* borrowed = borrowedRandEngine();
+    return borrowed != nullptr ? *borrowed : threadRandEngine();
+}
+
+  // Draw from engine on this thread from now on, or from the thread's own
+  // generator again if engine is nullptr; returns what was in use before
+
+inline
+RandSequence* useRandEngine(RandSequence* engine)
+{
+    RandSequence* previous = borrowedRandEngine();
+    borrowedRandEngine() = engine;
+    return previous;
+}
+
+  // Make this thread's randInt sequence repeatable, e.g. for benchmarks
+
+inline
+void seedRandInt(unsigned int seed)
+{
+    randEngine().seed(seed);
+}
+
   // Return a uniformly distributed random int from min to max, inclusive
 
 inline
@@ -78,10 +175,18 @@ int randInt(int min, int max)
 {
     if (max < min)
         std::swap(max, min);
-    static std::random_device rd;
-    static std::default_random_engine generator(rd());
-    std::uniform_int_distribution<> distro(min, max);
-    return distro(generator);
+      // Map onto the range here rather than with uniform_int_distribution,
+      // whose algorithm differs between standard libraries; that way a seeded
+      // run picks the same numbers on every platform.  Draws below threshold
+      // are rejected so that every value is equally likely.
+    std::uint32_t range = static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min) + 1;
+    std::uint32_t draw = randEngine()();
+    if (range == 0)     // min to max covers every int
+        return static_cast<int>(draw);
+    std::uint32_t threshold = (0u - range) % range;
+    while (draw < threshold)
+        draw = randEngine()();
+    return static_cast<int>(static_cast<std::uint32_t>(min) + draw % range);
 }
 
 #endif // GAMECONSTANTS_H_
@@ -5,11 +5,19 @@
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "AssetManifest.h"
+#include "Tracer.h"
+#include <fstream>
+#include <iomanip>
 #include <string>
 #include <map>
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <iterator>
 using namespace std;
 
 /*
@@ -43,65 +51,88 @@ static const double SCORE_Z = -10;
 
 static const int MS_PER_FRAME = 5;
 
-struct SpriteInfo
-{
-    int         imageID;
-    int         frameNum;
-    std::string tgaFileName;
-};
+static const double OVERLAY_LINE_SPACING = .3;
 
 static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void drawScoreAndLives(const char* gameStatText);
+static void outputStrokeCentered(double y, double z, const char* str);
 
 enum GameController::GameControllerState : int {
     welcome, init, makemove, animate, contgame, finishedlevel, cleanup,
     gameover, prompt, quit, not_applicable
 };
 
+  // How each state is labelled in a trace
+static const char* const STATE_NAMES[] = {
+    "welcome", "init", "makemove", "animate", "contgame", "finishedlevel", "cleanup",
+    "gameover", "prompt", "quit", "not_applicable"
+};
+
 void GameController::initDrawersAndSounds()
 {
-    SpriteInfo drawers[] = {
-	{ IID_PLAYER               , 0, "socrates.tga" },
-	{ IID_SALMONELLA           , 0, "salmonella1.tga" },
-	{ IID_SALMONELLA           , 1, "salmonella2.tga" },
-	{ IID_ECOLI                , 0, "ecoli1.tga" },
-	{ IID_ECOLI                , 1, "ecoli2.tga" },
-	{ IID_SPRAY                , 0, "water1.tga" },
-	{ IID_SPRAY                , 1, "water2.tga" },
-	{ IID_SPRAY                , 2, "water3.tga" },
-	{ IID_FLAME                , 0, "explosion.tga" },
-	{ IID_PIT                  , 0, "hole.tga" },
-	{ IID_FLAME_THROWER_GOODIE , 0, "flamethrow.tga" },
-	{ IID_RESTORE_HEALTH_GOODIE, 0, "health.tga" },
-	{ IID_EXTRA_LIFE_GOODIE    , 0, "life.tga" },
-	{ IID_FUNGUS               , 0, "fungus.tga" },
-	{ IID_DIRT                 , 0, "dirt.tga" },
-	{ IID_FOOD                 , 0, "pizza.tga" },
-    };
+    TRACE_SCOPE("start asset loading");
+    string path = m_gw->assetPath();
 
-    SoundMapType::value_type sounds[] = {
-	make_pair(SOUND_PLAYER_FIRE    , "flame.wav"),
-	make_pair(SOUND_SALMONELLA_HURT, "hurt.wav"),
-	make_pair(SOUND_ECOLI_HURT     , "hurt.wav"),
-	make_pair(SOUND_PLAYER_DIE     , "die.wav"),
-	make_pair(SOUND_GOT_GOODIE     , "goodie.wav"),
-	make_pair(SOUND_FINISHED_LEVEL , "finished.wav"),
-	make_pair(SOUND_PLAYER_SPRAY   , "squirt.wav"),
-	make_pair(SOUND_ECOLI_DIE      , "scream.wav"),
-	make_pair(SOUND_SALMONELLA_DIE , "scream.wav"),
-	make_pair(SOUND_THEME          , "theme.wav"),
-	make_pair(SOUND_PLAYER_HURT    , "ouch.wav"),
-	make_pair(SOUND_BACTERIUM_BORN , "born.wav")
-    };
+      // Prefer the pre-baked pack; otherwise decode the TGAs on worker
+      // threads.  Either way the uploads happen in doSomething while the
+      // welcome prompt is up.
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (m_assetPack.open(path + ASSET_PACK_NAME))
+    {
+        chrono::duration<double, milli> packOpen = chrono::steady_clock::now() - start;
+        m_spriteLoader.start(m_assetPack, packOpen.count(), SPRITE_ASSETS, size(SPRITE_ASSETS));
+    }
+    else
+        m_spriteLoader.start(path, SPRITE_ASSETS, size(SPRITE_ASSETS));
+    m_spritesLoaded = false;
 
-    string path = m_gw->assetPath();
-    for (const SpriteInfo& d : drawers)
+    for (const SoundAsset& s : SOUND_ASSETS)
+        m_soundMap[s.soundID] = s.wavFileName;
+    startMixer(path);
+}
+
+void GameController::startMixer(const string& path)
+{
+      // The mixer is the only sound there is on Linux; elsewhere it is used
+      // only if KONTAGION_AUDIO asks for it ("null", "wav:<file>" or "alsa").
+    const char* description = getenv("KONTAGION_AUDIO");
+#if !defined(__linux__)
+    if (description == nullptr)
+        return;
+#endif
+    unique_ptr<AudioSink> sink = makeAudioSink(description != nullptr ? description : "");
+    if (!sink)
+        return;
+
+    TRACE_SCOPE("load sounds");
+    for (SoundMapType::const_iterator p = m_soundMap.begin(); p != m_soundMap.end(); p++)
+    {
+        PackedSound packed;
+        if (m_assetPack.findSound(p->second, packed))
+        {
+            m_mixer.loadSound(p->first, packed);
+            continue;
+        }
+        vector<char> contents;
+        DecodedSound sound;
+        if (readAssetFile(path + p->second, contents)  &&
+            decodeWav(contents.data(), contents.size(), sound))
+            m_mixer.loadSound(p->first, sound);
+    }
+    m_mixer.start(move(sink));
+}
+
+void GameController::uploadLoadedSprites()
+{
+    if (!m_spriteLoader.uploadReady(m_spriteManager))
+        return;
+    if (m_spriteLoader.failed())
     {
-        if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
-            exit(1);
+        stopSimulationThread();
+        exit(1);
     }
-    for (const auto& s : sounds)
-        m_soundMap[s.first] = s.second;
+    m_spriteLoader.reportTiming(cout);
+    m_spritesLoaded = true;
 }
 
 static void doSomethingCallback()
@@ -130,15 +161,46 @@ static void timerFuncCallback(int)
     glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 }
 
+void GameController::setRandomSeed(unsigned int seed)
+{
+    m_randomSeed = seed;
+}
+
+unsigned int GameController::randomSeed() const
+{
+    return m_randomSeed;
+}
+
+void GameController::setPlaybackSpeed(double speed)
+{
+    if (speed > 0)
+        m_playbackSpeed = speed;
+}
+
+void GameController::setSkipPrompts(bool skip)
+{
+    m_skipPrompts = skip;
+}
+
 void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
 {
+    m_random.seed(m_randomSeed);
+    useRandEngine(&m_random);
+    m_tickPeriod = chrono::duration_cast<chrono::steady_clock::duration>(
+                       chrono::duration<double, milli>(MS_PER_TICK / m_playbackSpeed));
     gw->setController(this);
     m_gw = gw;
     setGameState(welcome);
-    m_lastKeyHit = INVALID_KEY;
     m_singleStep = false;
-    m_curIntraFrameTick = 0;
+    m_quitRequested = false;
     m_playerWon = false;
+    m_gameStatText[0] = '\0';
+    m_simRequest = sim_idle;
+    m_simStatus = SIM_RUNNING;
+    m_tickCount = 0;
+    m_runFirstTick = 1;
+    m_droppedKeys = 0;
+    m_showLatencies = false;
 
     glutInit(&argc, argv);
 
@@ -156,23 +218,29 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
     glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 
     glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
+    m_simThread = thread(&GameController::simulationLoop, this);
     glutMainLoop();
-    delete m_gw;
+    stopSimulationThread();
+    m_mixer.stop();
+    reportLatencies();
+    reportAssetMemory();
+    delete m_gw;       // reports the run's actor memory
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
 {
     switch (key)
     {
-        case 'a': case '4': m_lastKeyHit = KEY_PRESS_LEFT;  break;
-        case 'd': case '6': m_lastKeyHit = KEY_PRESS_RIGHT; break;
-        case 'w': case '8': m_lastKeyHit = KEY_PRESS_UP;    break;
-        case 's': case '2': m_lastKeyHit = KEY_PRESS_DOWN;  break;
-        case 't':           m_lastKeyHit = KEY_PRESS_TAB;   break;
-        case 'f':           m_singleStep = true;            break;
-        case 'r':           m_singleStep = false;           break;
-        case 'q': case 'Q': quitGame();                     break;
-        default:            m_lastKeyHit = key;             break;
+        case 'a': case '4': queueKey(KEY_PRESS_LEFT);  break;
+        case 'd': case '6': queueKey(KEY_PRESS_RIGHT); break;
+        case 'w': case '8': queueKey(KEY_PRESS_UP);    break;
+        case 's': case '2': queueKey(KEY_PRESS_DOWN);  break;
+        case 't':           queueKey(KEY_PRESS_TAB);   break;
+        case 'f':           m_singleStep = true;       break;
+        case 'r':           m_singleStep = false;      break;
+        case 'o':           m_showLatencies = !m_showLatencies; break;
+        case 'q': case 'Q': quitGame();                break;
+        default:            queueKey(key);             break;
     }
 }
 
@@ -180,16 +248,86 @@ void GameController::specialKeyboardEvent(int key, int /* x */, int /* y */)
 {
     switch (key)
     {
-        case GLUT_KEY_LEFT:  m_lastKeyHit = KEY_PRESS_LEFT;  break;
-        case GLUT_KEY_RIGHT: m_lastKeyHit = KEY_PRESS_RIGHT; break;
-        case GLUT_KEY_UP:    m_lastKeyHit = KEY_PRESS_UP;    break;
-        case GLUT_KEY_DOWN:  m_lastKeyHit = KEY_PRESS_DOWN;  break;
-        default:             m_lastKeyHit = INVALID_KEY;     break;
+        case GLUT_KEY_LEFT:  queueKey(KEY_PRESS_LEFT);  break;
+        case GLUT_KEY_RIGHT: queueKey(KEY_PRESS_RIGHT); break;
+        case GLUT_KEY_UP:    queueKey(KEY_PRESS_UP);    break;
+        case GLUT_KEY_DOWN:  queueKey(KEY_PRESS_DOWN);  break;
+        default:                                        break;
     }
 }
 
+void GameController::queueKey(int key)
+{
+    KeyEvent event = { key, chrono::steady_clock::now() };
+    if (!m_keyEvents.push(event))
+        m_droppedKeys++;
+}
+
+bool GameController::getPlayerKey(int& value)
+{
+    KeyEvent event;
+    if (!m_keyEvents.pop(event))
+        return false;
+    m_inputLatency.record(chrono::duration_cast<chrono::nanoseconds>(
+                              chrono::steady_clock::now() - event.time).count());
+    value = event.key;
+    return true;
+}
+
+void GameController::reportLatencies() const
+{
+      // Summarize each histogram, then save it whole as an .hgrm file
+      // (KONTAGION_HISTOGRAMS sets the file name prefix)
+    const char* prefix = getenv("KONTAGION_HISTOGRAMS");
+    string filePrefix = (prefix != nullptr ? prefix : "kontagion-");
+    struct { const char* name; const char* file; const LatencyHistogram* histogram; } reports[] = {
+        { "Tick time",     "tick.hgrm",  &m_tickTimes },
+        { "Draw time",     "draw.hgrm",  &m_drawTimes },
+        { "Input latency", "input.hgrm", &m_inputLatency },
+    };
+    const long long budgetNs = MS_PER_FRAME * 1000000LL;
+    for (const auto& r : reports)
+    {
+        const LatencyHistogram& h = *r.histogram;
+        if (h.count() == 0)
+            continue;
+        cout << fixed << setprecision(3) << r.name << ": " << h.count() << " samples, p50 "
+             << h.percentile(.5) / 1e6 << " ms, p99 " << h.percentile(.99) / 1e6 << " ms, p99.9 "
+             << h.percentile(.999) / 1e6 << " ms, max " << h.max() / 1e6 << " ms, "
+             << h.countAbove(budgetNs) << " over " << MS_PER_FRAME << " ms";
+        if (&h == &m_inputLatency  &&  m_droppedKeys > 0)
+            cout << ", " << m_droppedKeys << " dropped";
+        cout << defaultfloat << endl;
+
+        ofstream out(filePrefix + r.file);
+        if (out)
+            h.writePercentiles(out);
+    }
+}
+
+void GameController::reportAssetMemory() const
+{
+    cout << fixed << setprecision(1) << "Asset memory: sprite textures "
+         << m_spriteManager.textureBytes() / 1024.0 << " KB, sound clips "
+         << m_mixer.sampleBytes() / 1024.0 << " KB";
+    if (m_assetPack.isOpen())
+        cout << ", asset pack " << m_assetPack.bytes() / 1024.0 << " KB";
+    cout << defaultfloat << endl;
+}
+
+int GameController::freeSoundVoices() const
+{
+    return m_mixer.isRunning() ? m_mixer.freeVoices() : MAX_MIXER_VOICES;
+}
+
 void GameController::playSound(int soundID)
 {
+    if (m_mixer.isRunning())
+    {
+        m_mixer.play(soundID);
+        return;
+    }
+
     if (soundID == SOUND_NONE)
     {
         SoundFX().abortClip();
@@ -203,13 +341,22 @@ void GameController::playSound(int soundID)
 
 void GameController::setGameState(GameControllerState s)
 {
+    static_assert(size(STATE_NAMES) == not_applicable + 1, "every state needs a name");
     if (m_gameState != quit)
+    {
         m_gameState = s;
+        TRACE_INSTANT(STATE_NAMES[s]);
+    }
 }
 
 void GameController::setGameStateAfterPrompting(GameControllerState s,
                                     string mainMessage, string secondMessage)
 {
+    if (m_skipPrompts  &&  s != quit)
+    {
+        setGameState(s);
+        return;
+    }
     m_mainMessage = mainMessage;
     m_secondMessage = secondMessage;
     m_nextStateAfterPrompt = s;
@@ -218,11 +365,19 @@ void GameController::setGameStateAfterPrompting(GameControllerState s,
 
 void GameController::quitGame()
 {
-    setGameState(quit);
+      // May be called from the simulation thread, so just leave a note for
+      // the GLUT thread to act on.
+    m_quitRequested = true;
 }
 
 void GameController::doSomething()
 {
+    TRACE_SCOPE(STATE_NAMES[m_gameState]);
+    if (m_quitRequested)
+        setGameState(quit);
+    if (!m_spritesLoaded)
+        uploadLoadedSprites();
+
     switch (m_gameState)
     {
         case not_applicable:
@@ -232,9 +387,11 @@ void GameController::doSomething()
             setGameStateAfterPrompting(init, "Welcome to Kontagion!", "Press Enter to begin play...");
             break;
         case init:
+            if (!m_spritesLoaded)
+                break;      // still waiting on sprites
             {
                 int status = m_gw->init();
-                SoundFX().abortClip();
+                playSound(SOUND_NONE);
                 if (status == GWSTATUS_PLAYER_WON)
                 {
                     m_playerWon = true;
@@ -251,35 +408,22 @@ void GameController::doSomething()
             }
             break;
         case makemove:
-            m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-            m_nextStateAfterAnimate = not_applicable;
-            {
-                int status = m_gw->move();
-                if (status == GWSTATUS_PLAYER_DIED)
-                {
-                      // animate one last frame so the player can see what happened
-                    m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
-                }
-                else if (status == GWSTATUS_FINISHED_LEVEL)
-                {
-                    m_gw->advanceToNextLevel();
-                      // animate one last frame so the player can see what happened
-                    m_nextStateAfterAnimate = finishedlevel;
-                }
-            }
+            startSimulation();
             setGameState(animate);
             break;
         case animate:
-            displayGamePlay();
-            if (m_curIntraFrameTick-- <= 0)
             {
-                if (m_nextStateAfterAnimate != not_applicable)
-                    setGameState(m_nextStateAfterAnimate);
-                else
+                  // Read the status first: the final snapshot of a run is
+                  // published before its status, so the frame drawn below
+                  // lets the player see what happened.
+                int status = m_simStatus.load(memory_order_acquire);
+                displayGamePlay();
+                switch (m_gw->endRun(status))
                 {
-                    int key;
-                    if (!m_singleStep  ||  getLastKey(key))
-                        setGameState(makemove);
+                    case RUN_LOST_LIFE:      setGameState(contgame);       break;
+                    case RUN_FINISHED_LEVEL: setGameState(finishedlevel);  break;
+                    case RUN_GAME_OVER:      setGameState(gameover);       break;
+                    case RUN_CONTINUES:      break;
                 }
             }
             break;
@@ -313,14 +457,114 @@ void GameController::doSomething()
             }
             break;
         case quit:
-            SoundFX().abortClip();
+            stopSimulationThread();
+            playSound(SOUND_NONE);
             glutLeaveMainLoop();
             break;
     }
 }
 
+void GameController::startSimulation()
+{
+      // The simulation thread is idle, so m_tickCount is ours to read
+    m_runFirstTick = m_tickCount + 1;
+    m_simStatus.store(SIM_RUNNING, memory_order_relaxed);
+    m_simRequest.store(sim_run, memory_order_release);
+}
+
+void GameController::stopSimulationThread()
+{
+    if (!m_simThread.joinable())
+        return;
+    m_simRequest.store(sim_exit, memory_order_release);
+    m_simThread.join();
+}
+
+void GameController::simulationLoop()
+{
+    Tracer::nameThread("simulation");
+    useRandEngine(&m_random);   // the GLUT thread is idle while this one ticks
+    chrono::steady_clock::time_point nextTick;
+    bool running = false;
+    for (;;)
+    {
+        int request = m_simRequest.load(memory_order_acquire);
+        if (request == sim_exit)
+            return;
+        if (request != sim_run)
+        {
+            running = false;
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (!running)
+        {
+            running = true;
+            nextTick = now;
+        }
+        if (now < nextTick)
+        {
+            this_thread::sleep_until(nextTick);
+            continue;
+        }
+
+        int key;
+        if (m_singleStep  &&  !getLastKey(key))
+        {
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+
+          // Don't try to catch up on ticks missed while falling behind
+        nextTick = max(nextTick + m_tickPeriod, now);
+
+        GraphObject::beginTick();
+        chrono::steady_clock::time_point tickStart = chrono::steady_clock::now();
+        int status = m_gw->move();
+        m_gw->flushSounds();
+        publishSnapshot(now);
+        m_tickTimes.record(chrono::duration_cast<chrono::nanoseconds>(
+                               chrono::steady_clock::now() - tickStart).count());
+
+        if (status != GWSTATUS_CONTINUE_GAME)
+        {
+            int expected = sim_run;
+            m_simRequest.compare_exchange_strong(expected, sim_idle);
+            m_simStatus.store(status, memory_order_release);
+        }
+    }
+}
+
+void GameController::publishSnapshot(chrono::steady_clock::time_point tickTime)
+{
+    TRACE_SCOPE("publish snapshot");
+    WorldSnapshot& snapshot = m_snapshots.back();
+    GraphObject::snapshotAllObjects(snapshot.sprites);
+    memcpy(snapshot.statusText, m_gameStatText, MAX_STATUS_TEXT);
+    snapshot.tickTime = tickTime;
+    snapshot.tick = ++m_tickCount;
+    m_snapshots.publish();
+}
+
 void GameController::displayGamePlay()
 {
+    TRACE_SCOPE("draw");
+    chrono::steady_clock::time_point drawStart = chrono::steady_clock::now();
+    m_snapshots.update();
+    const WorldSnapshot& snapshot = m_snapshots.front();
+
+      // Until this run's first tick is published, the newest snapshot is
+      // the end of the last life or level; leave the screen as it is
+    if (snapshot.tick < m_runFirstTick)
+        return;
+
+      // Blend each sprite from where it was before the latest tick to where
+      // the tick left it, by how far we are into the next tick.
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - snapshot.tickTime;
+    double alpha = min(elapsed.count() / chrono::duration<double, milli>(m_tickPeriod).count(), 1.0);
+
     glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
     glLoadIdentity();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -333,20 +577,52 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-    GraphObject::drawAllObjects(
-        [=](int imageID, int animationNumber, double x, double y, int angle, double size)
-        {
-            int frame = animationNumber % m_spriteManager.getNumFrames(imageID);
-            m_spriteManager.plotSprite(imageID, frame, x, y, angle, size);
-        });
+    for (const SpriteSnapshot& sprite : snapshot.sprites)
+    {
+        int frame = sprite.frame % m_spriteManager.getNumFrames(sprite.imageID);
+        double x = sprite.prevX + (sprite.x - sprite.prevX) * alpha;
+        double y = sprite.prevY + (sprite.y - sprite.prevY) * alpha;
+        m_spriteManager.plotSprite(sprite.imageID, frame, x, y, sprite.angle, sprite.size);
+    }
 
-    drawScoreAndLives(m_gameStatText);
+    drawScoreAndLives(snapshot.statusText);
+    if (m_showLatencies)
+        drawLatencyOverlay();
 
     SpriteManager::drawCircle(VIEW_WIDTH / 2, VIEW_HEIGHT / 2, VIEW_WIDTH / 2 + SPRITE_WIDTH, 100);
 
+      // Swapping may wait for the display, which isn't our cost
+    m_drawTimes.record(chrono::duration_cast<chrono::nanoseconds>(
+                           chrono::steady_clock::now() - drawStart).count());
     glutSwapBuffers();
 }
 
+void GameController::drawLatencyOverlay()
+{
+      // Rebuilt a few times a second so the numbers can be read
+    static chrono::steady_clock::time_point lastUpdate;
+    static string lines[3];
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (now - lastUpdate >= chrono::milliseconds(250))
+    {
+        lastUpdate = now;
+        const char* names[] = { "tick", "draw", "input" };
+        const LatencyHistogram* histograms[] = { &m_tickTimes, &m_drawTimes, &m_inputLatency };
+        for (int i = 0; i < 3; i++)
+        {
+            const LatencyHistogram& h = *histograms[i];
+            ostringstream oss;
+            oss << fixed << setprecision(2) << names[i] << "  p50 " << h.percentile(.5) / 1e6
+                << "  p99 " << h.percentile(.99) / 1e6 << "  max " << h.max() / 1e6 << " ms";
+            lines[i] = oss.str();
+        }
+    }
+
+    glColor3f(.6f, .9f, .6f);
+    for (int i = 0; i < 3; i++)
+        outputStrokeCentered(SCORE_Y - OVERLAY_LINE_SPACING * (i + 1), SCORE_Z, lines[i].c_str());
+}
+
 void GameController::reshape (int w, int h)
 {
     glViewport (0, 0, (GLsizei) w, (GLsizei) h);
@@ -402,14 +678,32 @@ static void drawPrompt(string mainMessage, string secondMessage)
     glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(const char* gameStatText)
 {
+      // The status line only changes when a stat does, so stroke it into a
+      // display list once per change rather than glyph by glyph every frame.
+    static GLuint textList = 0;
+    static char cachedText[MAX_STATUS_TEXT] = "";
+    if (textList == 0  ||  strcmp(cachedText, gameStatText) != 0)
+    {
+        if (textList == 0)
+            textList = glGenLists(1);
+        strncpy(cachedText, gameStatText, MAX_STATUS_TEXT - 1);
+        glNewList(textList, GL_COMPILE);
+        outputStrokeCentered(SCORE_Y, SCORE_Z, cachedText);
+        glEndList();
+    }
+
+      // The flicker has its own generator so drawing doesn't consume the
+      // random numbers the game logic uses.
+    static minstd_rand flicker;
     static int RATE = 1;
     static GLfloat rgb[3] =
         { static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
     for (int k = 0; k < 3; k++)
     {
-        double strength = rgb[k] + randInt(-RATE, RATE) / 100.0;
+        int step = static_cast<int>(flicker() % (2 * RATE + 1)) - RATE;
+        double strength = rgb[k] + step / 100.0;
         if (strength < .6)
             strength = .6;
         else if (strength > 1.0)
@@ -417,5 +711,5 @@ static void drawScoreAndLives(string gameStatText)
         rgb[k] = static_cast<GLfloat>(strength);
     }
     glColor3f(rgb[0], rgb[1], rgb[2]);
-    outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
+    glCallList(textList);
 }
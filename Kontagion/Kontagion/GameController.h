@@ -2,16 +2,35 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "AssetPack.h"
+#include "SpriteLoader.h"
+#include "AudioMixer.h"
+#include "TripleBuffer.h"
+#include "SpscRing.h"
+#include "WorldSnapshot.h"
+#include "LatencyHistogram.h"
 #include <string>
 #include <map>
 #include <iostream>
 #include <sstream>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <cstring>
 
 const int INVALID_KEY = 0;
 
 class GraphObject;
 class GameWorld;
 
+  // A key press, stamped when GLUT delivered it
+struct KeyEvent
+{
+    int key;
+    std::chrono::steady_clock::time_point time;
+};
+
 class GameController
 {
   public:
@@ -19,20 +38,24 @@ class GameController
 
     bool getLastKey(int& value)
     {
-        if (m_lastKeyHit != INVALID_KEY)
-        {
-            value = m_lastKeyHit;
-            m_lastKeyHit = INVALID_KEY;
-            return true;
-        }
-        return false;
+        KeyEvent event;
+        if (!m_keyEvents.pop(event))
+            return false;
+        value = event.key;
+        return true;
     }
 
+      // Like getLastKey, but also records how long the key waited.  Used for
+      // the key that drives the player each tick.
+    bool getPlayerKey(int& value);
+
     void playSound(int soundID);
+    int freeSoundVoices() const;        // how many sounds can start without cutting one off
 
-    void setGameStatText(std::string text)
+    void setGameStatText(const char* text)
     {
-        m_gameStatText = text;
+        std::strncpy(m_gameStatText, text, MAX_STATUS_TEXT - 1);
+        m_gameStatText[MAX_STATUS_TEXT - 1] = '\0';
     }
 
     void doSomething();
@@ -43,6 +66,19 @@ class GameController
 
     void quitGame();
 
+      // Both threads that touch the world, the simulation thread and the
+      // GLUT thread (which calls init and cleanUp), draw their random numbers
+      // from one generator, seeded with this, so a session can be played
+      // again exactly.  Set before run; it is random otherwise.
+    void setRandomSeed(unsigned int seed);
+    unsigned int randomSeed() const;
+
+      // Also set before run, e.g. for watching a recording: how many times
+      // as fast as usual to tick, and whether to go straight past the
+      // prompts between lives and levels
+    void setPlaybackSpeed(double speed);
+    void setSkipPrompts(bool skip);
+
       // Meyers singleton pattern
     static GameController& getInstance()
     {
@@ -56,24 +92,68 @@ private:
     GameWorld*          m_gw;
     GameControllerState m_gameState;
     GameControllerState m_nextStateAfterPrompt;
-    GameControllerState m_nextStateAfterAnimate;
-    int         m_lastKeyHit;
-    bool        m_singleStep;
-    std::string m_gameStatText;
+      // Key presses travel from the GLUT thread to whichever thread is
+      // consuming input: the simulation thread while a level is running,
+      // otherwise the GLUT thread itself (prompts).
+    SpscRing<KeyEvent, 256> m_keyEvents;
+    long                m_droppedKeys;      // presses lost because the queue was full
+
+      // Where the time goes, kept for the whole run: how long each tick took
+      // on the simulation thread, how long each frame took to draw, and how
+      // long key presses waited between GLUT delivering them and the player's
+      // tick picking them up.  'o' shows them over the game.
+    LatencyHistogram    m_tickTimes;
+    LatencyHistogram    m_drawTimes;
+    LatencyHistogram    m_inputLatency;
+    bool                m_showLatencies;
+    std::atomic<bool>   m_singleStep;
+    std::atomic<bool>   m_quitRequested;
+    char        m_gameStatText[MAX_STATUS_TEXT];    // written only by the simulation thread
     std::string m_mainMessage;
     std::string m_secondMessage;
-    int         m_curIntraFrameTick;
     using SoundMapType = std::map<int, std::string>;
     using DrawMapType =  std::map<int, std::string>;
     SoundMapType  m_soundMap;
     bool          m_playerWon;
     SpriteManager m_spriteManager;
+    AssetPack     m_assetPack;
+    SpriteLoader  m_spriteLoader;
+    AudioMixer    m_mixer;
+    bool          m_spritesLoaded;
+
+      // The simulation thread ticks the world while the GLUT thread draws
+      // whatever snapshot was published last.  init and cleanUp still run on
+      // the GLUT thread, but only while the simulation thread is idle.
+    enum SimulationRequest : int { sim_idle, sim_run, sim_exit };
+    static const int SIM_RUNNING = -1;
+
+    std::thread                 m_simThread;
+    std::atomic<int>            m_simRequest;
+    std::atomic<int>            m_simStatus;    // SIM_RUNNING, or the GWSTATUS that ended the run
+    TripleBuffer<WorldSnapshot> m_snapshots;
+    unsigned long               m_tickCount;
+    unsigned long               m_runFirstTick; // the first tick of the current run
+    RandSequence                m_random;
+    unsigned int                m_randomSeed = std::random_device()();
+    double                      m_playbackSpeed = 1;
+    bool                        m_skipPrompts = false;
+    std::chrono::steady_clock::duration m_tickPeriod;
 
     void setGameState(GameControllerState s);
     void setGameStateAfterPrompting(GameControllerState s,
                             std::string mainMessage, std::string secondMessage);
 
+    void queueKey(int key);
+    void reportLatencies() const;
+    void reportAssetMemory() const;
+    void drawLatencyOverlay();
     void initDrawersAndSounds();
+    void uploadLoadedSprites();
+    void startMixer(const std::string& path);
+    void simulationLoop();
+    void publishSnapshot(std::chrono::steady_clock::time_point tickTime);
+    void startSimulation();
+    void stopSimulationThread();
     void displayGamePlay();
 };
 
@@ -1,27 +1,108 @@
 #include "GameWorld.h"
 #include "GameController.h"
+#include "ActorProfiler.h"
 #include <string>
+#include <algorithm>
 #include <cstdlib>
 using namespace std;
 
+  // A world without a controller (e.g. one being benchmarked) runs
+  // headless: no keys arrive, and sounds and status text go nowhere.
+
 bool GameWorld::getKey(int& value)
 {
-    bool gotKey = m_controller->getLastKey(value);
+    if (m_controller == nullptr)
+        return false;
+
+    bool gotKey = m_controller->getPlayerKey(value);
 
     if (gotKey)
     {
         if (value == 'q'  ||  value == '\x03')  // CTRL-C
             m_controller->quitGame();
+        if (value == 'p')
+            PROFILE_ACTORS_DUMP(cout);      // only in KONTAGION_PROFILE_ACTORS builds
     }
     return gotKey;
 }
 
+RunOutcome GameWorld::endRun(int status)
+{
+    if (status == GWSTATUS_FINISHED_LEVEL)
+    {
+        advanceToNextLevel();
+        return RUN_FINISHED_LEVEL;
+    }
+    if (status == GWSTATUS_PLAYER_DIED)
+        return isGameOver() ? RUN_GAME_OVER : RUN_LOST_LIFE;
+    return RUN_CONTINUES;
+}
+
+  // Sound priorities, indexed by sound ID; higher plays first
+static const int SOUND_PRIORITIES[] = {
+    10,     // SOUND_PLAYER_DIE
+     4,     // SOUND_SALMONELLA_DIE
+     2,     // SOUND_SALMONELLA_HURT
+     6,     // SOUND_PLAYER_FIRE
+     6,     // SOUND_PLAYER_SPRAY
+     7,     // SOUND_GOT_GOODIE
+     9,     // SOUND_FINISHED_LEVEL
+     4,     // SOUND_ECOLI_DIE
+     2,     // SOUND_ECOLI_HURT
+     8,     // SOUND_PLAYER_HURT
+     0,     // SOUND_THEME
+     1,     // SOUND_BACTERIUM_BORN
+};
+const int NUM_SOUND_IDS = sizeof(SOUND_PRIORITIES) / sizeof(SOUND_PRIORITIES[0]);
+static_assert(NUM_SOUND_IDS == SOUND_BACTERIUM_BORN + 1, "every sound needs a priority");
+
 void GameWorld::playSound(int soundID)
 {
-    m_controller->playSound(soundID);
+    if (soundID == SOUND_NONE)
+    {
+          // Stopping everything also drops whatever was queued before
+        m_pendingSounds = 0;
+        m_stopSounds = true;
+    }
+    else if (soundID >= 0  &&  soundID < NUM_SOUND_IDS)
+        m_pendingSounds |= 1u << soundID;
+}
+
+void GameWorld::flushSounds()
+{
+    if (m_controller == nullptr)
+    {
+        m_pendingSounds = 0;
+        m_stopSounds = false;
+        return;
+    }
+
+    if (m_stopSounds)
+        m_controller->playSound(SOUND_NONE);
+    m_stopSounds = false;
+
+      // Start no more distinct sounds than the mixer has voices free, so a
+      // busy tick doesn't cut off what is already playing; the rest are
+      // dropped, lowest priority first.  The most important one always
+      // starts, stealing a voice if it must.
+    int budget = max(1, m_controller->freeSoundVoices());
+    for (int started = 0; started < budget  &&  m_pendingSounds != 0; started++)
+    {
+        int best = -1;
+        for (int id = 0; id < NUM_SOUND_IDS; id++)
+        {
+            if ((m_pendingSounds & (1u << id))  &&
+                (best == -1  ||  SOUND_PRIORITIES[id] > SOUND_PRIORITIES[best]))
+                best = id;
+        }
+        m_controller->playSound(best);
+        m_pendingSounds &= ~(1u << best);
+    }
+    m_pendingSounds = 0;
 }
 
-void GameWorld::setGameStatText(string text)
+void GameWorld::setGameStatText(const char* text)
 {
-    m_controller->setGameStatText(text);
+    if (m_controller != nullptr)
+        m_controller->setGameStatText(text);
 }
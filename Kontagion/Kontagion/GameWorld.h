@@ -6,6 +6,15 @@
 
 const int START_PLAYER_LIVES = 3;
 
+  // How a tick left the current run (one life on one level)
+enum RunOutcome
+{
+    RUN_CONTINUES,
+    RUN_LOST_LIFE,          // cleanUp and init to play the level again
+    RUN_FINISHED_LEVEL,     // cleanUp and init to play the next level
+    RUN_GAME_OVER           // cleanUp; there is no next run
+};
+
 class GameController;
 
 class GameWorld
@@ -14,7 +23,8 @@ public:
 
     GameWorld(std::string assetPath)
      : m_lives(START_PLAYER_LIVES), m_score(0), m_level(1),
-       m_controller(nullptr), m_assetPath(assetPath)
+       m_controller(nullptr), m_assetPath(assetPath),
+       m_pendingSounds(0), m_stopSounds(false)
     {
     }
 
@@ -26,9 +36,13 @@ public:
     virtual int move() = 0;
     virtual void cleanUp() = 0;
 
-    void setGameStatText(std::string text);
+    void setGameStatText(const char* text);
 
     bool getKey(int& value);
+
+      // Sounds are only queued here; the framework starts them once the
+      // tick is over, so a flame that hits a dozen bacteria plays one hurt
+      // sound rather than a dozen.
     void playSound(int soundID);
 
     int getLevel() const
@@ -77,11 +91,20 @@ public:
     {
         ++m_level;
     }
+
+      // Takes the status move() returned, moves on to the next level if
+      // this one was finished, and says what has to happen next.
+      // GameController prompts the player before the cleanUp and init it
+      // calls for; headless drivers call them straight away.
+    RunOutcome endRun(int status);
    
     void setController(GameController* controller)
     {
         m_controller = controller;
     }
+
+      // Start this tick's queued sounds, highest priority first
+    void flushSounds();
     
 private:
     int m_lives;
@@ -89,6 +112,8 @@ private:
     int m_level;
     GameController* m_controller;
     std::string     m_assetPath;
+    unsigned int    m_pendingSounds;    // bit n set if sound ID n was played this tick
+    bool            m_stopSounds;
 };
 
 #endif // GAMEWORLD_H_
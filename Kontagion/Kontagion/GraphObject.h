@@ -3,12 +3,12 @@
 
 #include "SpriteManager.h"
 #include "GameConstants.h"
+#include "WorldSnapshot.h"
 
 #include <set>
+#include <vector>
 #include <cmath>
 
-const int ANIMATION_POSITIONS_PER_TICK = 1;
-
 using Direction = int;
 
 class GraphObject
@@ -21,18 +21,21 @@ class GraphObject
     static const int down = 270;
 
     GraphObject(int imageID, double startX, double startY, Direction dir = 0, int depth = 0, double size = 1.0)
-     : m_imageID(imageID), m_x(startX), m_y(startY), m_destX(startX), m_destY(startY),
-       m_animationNumber(0), m_direction(dir), m_depth(depth), m_size(size)
+     : m_imageID(imageID), m_prevX(startX), m_prevY(startY),
+       m_destX(startX), m_destY(startY), m_animationNumber(0), m_direction(dir), m_depth(depth), m_size(size),
+       m_registry(currentRegistry())
     {
         if (m_size <= 0)
             m_size = 1;
 
-        getGraphObjects(m_depth).insert(this);
+        objectsAt(m_registry, m_depth).insert(this);
     }
 
     virtual ~GraphObject()
     {
-        getGraphObjects(m_depth).erase(this);
+          // Erase from the registry the object joined, whichever thread
+          // destroys it
+        objectsAt(m_registry, m_depth).erase(this);
     }
 
     double getX() const
@@ -106,62 +109,111 @@ class GraphObject
         m_animationNumber++;
     }
 
-    template<typename Func>
-    static void drawAllObjects(Func plotFunc)
+      // Remember where every object is before the next tick moves it, so
+      // frames drawn during that tick can blend from there to the new spot.
+    static void beginTick()
     {
+        for (int depth = 0; depth < NUM_DEPTHS; depth++)
+        {
+            for (GraphObject* go : getGraphObjects(depth))
+            {
+                go->m_prevX = go->m_destX;
+                go->m_prevY = go->m_destY;
+            }
+        }
+    }
+
+      // Record everything needed to draw the world, in drawing order, so a
+      // renderer on another thread can plot it without touching live objects.
+    static void snapshotAllObjects(std::vector<SpriteSnapshot>& sprites)
+    {
+        sprites.clear();
         for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
         {
             for (GraphObject* go : getGraphObjects(depth))
             {
-                go->animate();
-                plotFunc(go->m_imageID, go->m_animationNumber, go->m_x, go->m_y, go->m_direction, go->m_size);
+                SpriteSnapshot s;
+                s.imageID = go->m_imageID;
+                s.frame = go->m_animationNumber;
+                s.prevX = static_cast<float>(go->m_prevX);
+                s.prevY = static_cast<float>(go->m_prevY);
+                s.x = static_cast<float>(go->m_destX);
+                s.y = static_cast<float>(go->m_destY);
+                s.angle = go->m_direction;
+                s.size = static_cast<float>(go->m_size);
+                s.depth = depth;
+                sprites.push_back(s);
             }
         }
     }
 
+    static const int NUM_DEPTHS = 4;
+
+      // The objects to draw, one set per depth.  Every thread adds objects to
+      // the same registry unless it switches to one of its own, as each of
+      // the training environments does so that worlds being stepped on
+      // different threads never share a set.
+    struct Registry
+    {
+        std::set<GraphObject*> objects[NUM_DEPTHS];
+    };
+
+      // New objects on this thread join registry from now on, and beginTick,
+      // snapshotAllObjects and objectCount look there; nullptr goes back to
+      // the shared one.  Returns the registry in use before.
+    static Registry* useRegistry(Registry* registry)
+    {
+        Registry* previous = currentRegistry();
+        currentRegistry() = (registry != nullptr ? registry : &sharedRegistry());
+        return previous;
+    }
+
+      // How many objects are drawn at a depth, for memory accounting
+    static std::size_t objectCount(int depth)
+    {
+        return getGraphObjects(depth).size();
+    }
+
       // Prevent copying or assigning GraphObjects
     GraphObject(const GraphObject&) = delete;
     GraphObject& operator=(const GraphObject&) = delete;
 
   private:
 
-    static const int NUM_DEPTHS = 4;
     int     m_imageID;
-    double  m_x;
-    double  m_y;
+    double  m_prevX;
+    double  m_prevY;
     double  m_destX;
     double  m_destY;
     int     m_animationNumber;
     Direction   m_direction;
     int     m_depth;
     double  m_size;
+    Registry*   m_registry;
 
-    void animate()
+    static Registry& sharedRegistry()
     {
-        m_x = m_destX;
-        m_y = m_destY;
-        //moveALittle(m_x, m_destX);
-        //moveALittle(m_y, m_destY);
+        static Registry registry;
+        return registry;
     }
 
-    void moveALittle(double& from, double& to)
+    static Registry*& currentRegistry()
     {
-        static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
-        if (to - from >= DISTANCE)
-            from += DISTANCE;
-        else if (from - to >= DISTANCE)
-            from -= DISTANCE;
-        else
-            from = to;
+        static thread_local Registry* current = &sharedRegistry();
+        return current;
     }
 
-    static std::set<GraphObject*>& getGraphObjects(int depth)
+    static std::set<GraphObject*>& objectsAt(Registry* registry, int depth)
     {
-        static std::set<GraphObject*> graphObjects[NUM_DEPTHS];
         if (depth < NUM_DEPTHS)
-            return graphObjects[depth];
+            return registry->objects[depth];
         else
-            return graphObjects[0];     // empty;
+            return registry->objects[0];     // empty;
+    }
+
+    static std::set<GraphObject*>& getGraphObjects(int depth)
+    {
+        return objectsAt(currentRegistry(), depth);
     }
 };
 
@@ -0,0 +1,136 @@
+#include "HeuristicBot.h"
+#include "ActorWorld.h"
+#include "Actor.h"
+#include "GameConstants.h"
+#include <cmath>
+using namespace std;
+
+namespace {
+
+  // How far short of this a spray or a ring of flames reaches from
+  // Socrates: each starts a sprite's width out and checks for a hit (less
+  // than a width away) before each step of a width, until it has gone its
+  // range
+const double SPRAY_REACH = 112 + SPRITE_WIDTH;
+const double FLAME_REACH = 32 + SPRITE_WIDTH;
+
+  // Bacteria within burning range that make flames worth one of the charges
+const int SURROUNDED = 3;
+
+  // A bacterium this close takes priority over any goodie
+const double PRESSING = 64;
+
+  // Socrates turns 5 degrees a key press, so closer than half that is as
+  // lined up as he can get
+const double TURN_STEP = 5;
+
+const double PI = 4 * atan(1);
+
+double normalizedDegrees(double degrees)
+{
+    degrees = fmod(degrees, 360);
+    if (degrees > 180)
+        degrees -= 360;
+    else if (degrees <= -180)
+        degrees += 360;
+    return degrees;
+}
+
+struct Survey
+{
+    double x;               // Socrates, and the way he faces
+    double y;
+    double aheadX;
+    double aheadY;
+    double facing;          // in degrees
+
+    int          nearby;            // bacteria within FLAME_REACH
+    bool         inLine;            // a bacterium in the spray's path
+    const Actor* nearest;           // bacterium
+    double       nearestDistance;
+    const Actor* goodie;            // the one the fewest turns away
+    double       goodieTurn;
+
+      // How far Socrates must turn to be on the line from the centre of the
+      // dish through actor, between it and the rim: the spot from which a
+      // spray would hit it, or the one on the rim beside a goodie
+    double turnToward(const Actor* actor) const
+    {
+        double angle = atan2(actor->getY() - VIEW_HEIGHT / 2, actor->getX() - VIEW_WIDTH / 2) * 180 / PI;
+        return normalizedDegrees(angle + 180 - facing);
+    }
+
+    static void look(const Actor* actor, void* context)
+    {
+        Survey& s = *static_cast<Survey*>(context);
+        ActorType type = actor->getType();
+        if (type == ACTOR_HEALTH_GOODIE  ||  type == ACTOR_FLAME_GOODIE  ||  type == ACTOR_LIFE_GOODIE)
+        {
+            double turn = s.turnToward(actor);
+            if (s.goodie == nullptr  ||  fabs(turn) < fabs(s.goodieTurn))
+            {
+                s.goodie = actor;
+                s.goodieTurn = turn;
+            }
+            return;
+        }
+        if (!actor->isBacteria())
+            return;
+
+        double dx = actor->getX() - s.x;
+        double dy = actor->getY() - s.y;
+        double distance = sqrt(dx * dx + dy * dy);
+        if (distance < FLAME_REACH)
+            s.nearby++;
+        double ahead = dx * s.aheadX + dy * s.aheadY;
+        double across = dy * s.aheadX - dx * s.aheadY;
+        if (ahead > 0  &&  ahead < SPRAY_REACH  &&  fabs(across) < SPRITE_WIDTH)
+            s.inLine = true;
+        if (s.nearest == nullptr  ||  distance < s.nearestDistance)
+        {
+            s.nearest = actor;
+            s.nearestDistance = distance;
+        }
+    }
+};
+
+bool turn(double degrees, int& key)
+{
+    if (fabs(degrees) < TURN_STEP / 2)
+        return false;       // already lined up; wait, and let the spray recharge
+    key = (degrees > 0 ? KEY_PRESS_LEFT : KEY_PRESS_RIGHT);    // left turns anticlockwise
+    return true;
+}
+
+}  // namespace
+
+bool HeuristicBot::nextKey(const ActorWorld& world, int& key)
+{
+    const Socrates* socrates = world.getSocrates();
+    if (socrates == nullptr)
+        return false;
+
+    Survey s = Survey();
+    s.x = socrates->getX();
+    s.y = socrates->getY();
+    s.facing = socrates->getDirection();
+    s.aheadX = cos(s.facing * PI / 180);
+    s.aheadY = sin(s.facing * PI / 180);
+    world.visitActors(Survey::look, &s);
+
+    if (s.nearby >= SURROUNDED  &&  socrates->flamesRemaining() > 0)
+    {
+        key = KEY_PRESS_ENTER;
+        return true;
+    }
+    if (s.inLine  &&  socrates->spraysRemaining() > 0)
+    {
+        key = KEY_PRESS_SPACE;
+        return true;
+    }
+    if (s.goodie != nullptr  &&  (s.nearest == nullptr  ||  s.nearestDistance > PRESSING))
+        return turn(s.goodieTurn, key);
+    if (s.nearest != nullptr)
+        return turn(s.turnToward(s.nearest), key);
+    return false;
+}
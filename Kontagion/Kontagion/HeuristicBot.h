@@ -0,0 +1,24 @@
+#ifndef HEURISTICBOT_H_
+#define HEURISTICBOT_H_
+
+#include "InputPolicy.h"
+
+  // Plays Socrates well enough to keep a dish busy for load tests.  Each
+  // tick, in this order, it
+  //
+  //   throws flames if enough bacteria are close enough to burn,
+  //   sprays if a bacterium is in the spray's path,
+  //   heads around the rim for a goodie if no bacterium is pressing,
+  //   otherwise turns toward the nearest bacterium,
+  //
+  // and does nothing (so the spray recharges) when out of spray or when
+  // there is nothing to do.  Fungi are left alone.  It looks only at the
+  // world, so the same dish always gets the same play.
+
+class HeuristicBot : public InputPolicy
+{
+  public:
+    virtual bool nextKey(const ActorWorld& world, int& key);
+};
+
+#endif // HEURISTICBOT_H_
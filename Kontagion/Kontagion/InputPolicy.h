@@ -0,0 +1,20 @@
+#ifndef INPUTPOLICY_H_
+#define INPUTPOLICY_H_
+
+class ActorWorld;
+
+  // Chooses the key Socrates acts on each tick in place of the keyboard, so
+  // bots, training environments and headless runs can play.  A world uses
+  // one once it is given it with ActorWorld::setInputPolicy.
+
+class InputPolicy
+{
+  public:
+    virtual ~InputPolicy() {}
+
+      // Sets key to a KEY_PRESS_ value and returns true to press it this
+      // tick, or returns false for no key, which lets the spray recharge
+    virtual bool nextKey(const ActorWorld& world, int& key) = 0;
+};
+
+#endif // INPUTPOLICY_H_
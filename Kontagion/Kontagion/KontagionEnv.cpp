@@ -0,0 +1,495 @@
+#include "KontagionEnv.h"
+#include "ActorWorld.h"
+#include "Actor.h"
+#include "GameConstants.h"
+#include "Tracer.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+namespace {
+
+const int NO_KEY = 0;
+
+const int ACTION_KEYS[KontagionEnv::NUM_ACTIONS] = {
+    NO_KEY, KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_SPACE, KEY_PRESS_ENTER
+};
+
+enum Category { CATEGORY_HOSTILE, CATEGORY_GOODIE, CATEGORY_DIRT, CATEGORY_OTHER, NUM_CATEGORIES };
+
+static_assert(KontagionEnv::SLOT_SIZE == 4 + NUM_CATEGORIES, "an observation slot is filled, ahead, across, distance, then the categories");
+
+  // -1 for what observations leave out
+int categoryOf(ActorType type)
+{
+    switch (type)
+    {
+      case ACTOR_REGULAR_SALMONELLA:
+      case ACTOR_AGGRESSIVE_SALMONELLA:
+      case ACTOR_ECOLI:
+      case ACTOR_FUNGUS:
+        return CATEGORY_HOSTILE;
+      case ACTOR_HEALTH_GOODIE:
+      case ACTOR_FLAME_GOODIE:
+      case ACTOR_LIFE_GOODIE:
+        return CATEGORY_GOODIE;
+      case ACTOR_DIRT:
+        return CATEGORY_DIRT;
+      case ACTOR_FOOD:
+      case ACTOR_PIT:
+        return CATEGORY_OTHER;
+      default:
+        return -1;
+    }
+}
+
+  // The actors closest to Socrates so far, nearest first
+struct Nearest
+{
+    double x;
+    double y;
+    int    count;
+    struct
+    {
+        double       distanceSq;
+        const Actor* actor;
+    } slots[KontagionEnv::NEAREST_ACTORS];
+
+    static void consider(const Actor* actor, void* context)
+    {
+        if (categoryOf(actor->getType()) < 0)
+            return;
+        Nearest& n = *static_cast<Nearest*>(context);
+        double dx = actor->getX() - n.x;
+        double dy = actor->getY() - n.y;
+        double distanceSq = dx * dx + dy * dy;
+        if (n.count == KontagionEnv::NEAREST_ACTORS  &&  distanceSq >= n.slots[n.count - 1].distanceSq)
+            return;
+
+          // Insertion into a short sorted array
+        int i = (n.count < KontagionEnv::NEAREST_ACTORS ? n.count++ : n.count - 1);
+        for ( ; i > 0  &&  n.slots[i - 1].distanceSq > distanceSq; i--)
+            n.slots[i] = n.slots[i - 1];
+        n.slots[i].distanceSq = distanceSq;
+        n.slots[i].actor = actor;
+    }
+};
+
+}  // namespace
+
+  // Points this thread's new objects and random numbers at the environment
+  // for as long as it is in scope
+class KontagionEnv::Scope
+{
+  public:
+    explicit Scope(KontagionEnv& env)
+     : m_registry(GraphObject::useRegistry(&env.m_registry)), m_random(useRandEngine(&env.m_random))
+    {
+    }
+
+    ~Scope()
+    {
+        GraphObject::useRegistry(m_registry);
+        useRandEngine(m_random);
+    }
+
+  private:
+    GraphObject::Registry* m_registry;
+    RandSequence*          m_random;
+};
+
+KontagionEnv::KontagionEnv(long long episodeTicks)
+ : m_over(true), m_ticks(0), m_episodeTicks(episodeTicks)
+{
+    m_input.key = NO_KEY;
+}
+
+KontagionEnv::~KontagionEnv()
+{
+    Scope scope(*this);
+    m_world.reset();
+}
+
+bool KontagionEnv::ActionInput::nextKey(const ActorWorld&, int& value)
+{
+    value = key;
+    return key != NO_KEY;
+}
+
+void KontagionEnv::reset(unsigned int seed, float* observation)
+{
+    Scope scope(*this);
+    m_world.reset();
+    m_random.seed(seed);
+    m_world.reset(new ActorWorld(""));
+    m_world->reportMemoryTo(nullptr);
+    m_world->watchdog().configure(0, 1);
+    m_world->setInputPolicy(&m_input);
+    m_world->init();
+    m_input.key = NO_KEY;
+    m_over = false;
+    m_ticks = 0;
+    observe(observation);
+}
+
+StepResult KontagionEnv::step(int action, float* observation)
+{
+    StepResult result = { 0, true, false };
+    if (m_over)
+    {
+          // Nothing more happens until the next reset
+        observe(observation);
+        return result;
+    }
+
+    Scope scope(*this);
+    m_input.key = (action >= 0  &&  action < NUM_ACTIONS ? ACTION_KEYS[action] : NO_KEY);
+    int scoreBefore = m_world->getScore();
+    int status = m_world->move();
+    m_world->flushSounds();
+    m_ticks++;
+    result.reward = static_cast<float>(m_world->getScore() - scoreBefore);
+    result.done = false;
+
+      // The same transitions GameController makes, except that game over
+      // ends the episode
+    RunOutcome outcome = m_world->endRun(status);
+    if (outcome == RUN_GAME_OVER)
+    {
+        m_world->cleanUp();
+        m_over = true;
+        result.done = true;
+    }
+    else if (outcome != RUN_CONTINUES)
+    {
+        m_world->cleanUp();
+        m_world->init();
+    }
+
+    if (!result.done  &&  m_episodeTicks > 0  &&  m_ticks >= m_episodeTicks)
+    {
+        m_over = true;
+        result.done = true;
+        result.truncated = true;
+    }
+
+    observe(observation);
+    return result;
+}
+
+int KontagionEnv::score() const
+{
+    return m_world ? m_world->getScore() : 0;
+}
+
+int KontagionEnv::level() const
+{
+    return m_world ? m_world->getLevel() : 0;
+}
+
+int KontagionEnv::lives() const
+{
+    return m_world ? m_world->getLives() : 0;
+}
+
+long long KontagionEnv::ticks() const
+{
+    return m_ticks;
+}
+
+const OccupancyGrid* KontagionEnv::occupancy() const
+{
+    return m_world  &&  !m_over ? &m_world->occupancy() : nullptr;
+}
+
+void KontagionEnv::copyOccupancy(uint8_t* out) const
+{
+    const OccupancyGrid* grid = occupancy();
+    if (grid != nullptr)
+        memcpy(out, grid->layers(), OCCUPANCY_BYTES);
+    else
+        memset(out, 0, OCCUPANCY_BYTES);
+}
+
+void KontagionEnv::observe(float* observation) const
+{
+    for (int i = 0; i < OBSERVATION_SIZE; i++)
+        observation[i] = 0;
+    const Socrates* socrates = (m_world ? m_world->getSocrates() : nullptr);
+    if (socrates == nullptr)
+        return;
+
+    const double PI = 4 * atan(1);
+    double facing = socrates->getDirection() * PI / 180;
+    double aheadX = cos(facing);
+    double aheadY = sin(facing);
+    observation[0] = static_cast<float>(aheadX);
+    observation[1] = static_cast<float>(aheadY);
+    observation[2] = socrates->getHealth() / 100.0f;
+    observation[3] = socrates->spraysRemaining() / 20.0f;
+    observation[4] = socrates->flamesRemaining() / 5.0f;
+    observation[5] = m_world->getLives() / 3.0f;
+    observation[6] = m_world->getLevel() / 10.0f;
+
+    Nearest nearest;
+    nearest.x = socrates->getX();
+    nearest.y = socrates->getY();
+    nearest.count = 0;
+    m_world->visitActors(Nearest::consider, &nearest);
+
+    float* slot = observation + SOCRATES_FIELDS;
+    for (int i = 0; i < nearest.count; i++, slot += SLOT_SIZE)
+    {
+        const Actor* actor = nearest.slots[i].actor;
+        double dx = actor->getX() - nearest.x;
+        double dy = actor->getY() - nearest.y;
+        slot[0] = 1;
+        slot[1] = static_cast<float>((dx * aheadX + dy * aheadY) / VIEW_WIDTH);
+        slot[2] = static_cast<float>((dy * aheadX - dx * aheadY) / VIEW_WIDTH);
+        slot[3] = static_cast<float>(sqrt(nearest.slots[i].distanceSq) / VIEW_WIDTH);
+        slot[4 + categoryOf(actor->getType())] = 1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  VecKontagionEnv
+///////////////////////////////////////////////////////////////////////////
+
+VecKontagionEnv::VecKontagionEnv(int numEnvs, int threads, long long episodeTicks, bool withOccupancy)
+ : m_observations(static_cast<size_t>(numEnvs) * KontagionEnv::OBSERVATION_SIZE),
+   m_occupancies(withOccupancy ? static_cast<size_t>(numEnvs) * KontagionEnv::OCCUPANCY_BYTES : 0),
+   m_rewards(numEnvs), m_dones(numEnvs), m_truncations(numEnvs), m_nextSeeds(numEnvs),
+   m_seedStride(numEnvs), m_job(JOB_NONE), m_actions(nullptr), m_generation(0), m_busy(0)
+{
+    for (int i = 0; i < numEnvs; i++)
+        m_envs.emplace_back(new KontagionEnv(episodeTicks));
+
+    if (threads <= 0)
+        threads = static_cast<int>(thread::hardware_concurrency());
+    if (threads > numEnvs)
+        threads = numEnvs;
+    for (int share = 1; share < threads; share++)
+        m_workers.emplace_back(&VecKontagionEnv::workerLoop, this, share);
+}
+
+VecKontagionEnv::~VecKontagionEnv()
+{
+    runJob(JOB_QUIT);
+    for (thread& worker : m_workers)
+        worker.join();
+}
+
+void VecKontagionEnv::reset(unsigned int seed)
+{
+    for (size_t i = 0; i < m_nextSeeds.size(); i++)
+        m_nextSeeds[i] = seed + static_cast<unsigned int>(i);
+    runJob(JOB_RESET);
+}
+
+void VecKontagionEnv::step(const int* actions)
+{
+    TRACE_SCOPE("VecKontagionEnv::step");
+    m_actions = actions;
+    runJob(JOB_STEP);
+    m_actions = nullptr;
+}
+
+void VecKontagionEnv::runJob(Job job)
+{
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_job = job;
+        m_generation++;
+        m_busy = static_cast<int>(m_workers.size());
+    }
+    m_wake.notify_all();
+    if (job != JOB_QUIT)
+        doShare(0, job);
+
+    unique_lock<mutex> lock(m_lock);
+    m_finished.wait(lock, [this] { return m_busy == 0; });
+}
+
+void VecKontagionEnv::workerLoop(int share)
+{
+    Tracer::nameThread("env worker");
+    unsigned long long seen = 0;
+    for (;;)
+    {
+        Job job;
+        {
+            unique_lock<mutex> lock(m_lock);
+            m_wake.wait(lock, [this, seen] { return m_generation != seen; });
+            seen = m_generation;
+            job = m_job;
+        }
+        if (job != JOB_QUIT)
+            doShare(share, job);
+
+        bool last;
+        {
+            lock_guard<mutex> lock(m_lock);
+            last = (--m_busy == 0);
+        }
+        if (last)
+            m_finished.notify_one();
+        if (job == JOB_QUIT)
+            return;
+    }
+}
+
+  // Each thread always takes the same run of environments, so they stay in
+  // its cache
+void VecKontagionEnv::doShare(int share, Job job)
+{
+    int numEnvs = size();
+    int shares = threads();
+    int first = static_cast<int>(static_cast<long long>(numEnvs) * share / shares);
+    int last = static_cast<int>(static_cast<long long>(numEnvs) * (share + 1) / shares);
+    for (int i = first; i < last; i++)
+    {
+        if (job == JOB_RESET)
+        {
+            m_rewards[i] = 0;
+            m_dones[i] = m_truncations[i] = 0;
+            resetEnv(i);
+        }
+        else if (job == JOB_STEP)
+        {
+            float* observation = &m_observations[static_cast<size_t>(i) * KontagionEnv::OBSERVATION_SIZE];
+            StepResult result = m_envs[i]->step(m_actions[i], observation);
+            m_rewards[i] = result.reward;
+            m_dones[i] = result.done;
+            m_truncations[i] = result.truncated;
+            if (result.done)
+                resetEnv(i);
+        }
+        if (!m_occupancies.empty())
+            m_envs[i]->copyOccupancy(&m_occupancies[static_cast<size_t>(i) * KontagionEnv::OCCUPANCY_BYTES]);
+    }
+}
+
+void VecKontagionEnv::resetEnv(int i)
+{
+    float* observation = &m_observations[static_cast<size_t>(i) * KontagionEnv::OBSERVATION_SIZE];
+    m_envs[i]->reset(m_nextSeeds[i], observation);
+    m_nextSeeds[i] += m_seedStride;
+}
+
+int VecKontagionEnv::size() const
+{
+    return static_cast<int>(m_envs.size());
+}
+
+int VecKontagionEnv::threads() const
+{
+    return static_cast<int>(m_workers.size()) + 1;
+}
+
+const float* VecKontagionEnv::observations() const
+{
+    return m_observations.data();
+}
+
+const uint8_t* VecKontagionEnv::occupancies() const
+{
+    return m_occupancies.empty() ? nullptr : m_occupancies.data();
+}
+
+const float* VecKontagionEnv::rewards() const
+{
+    return m_rewards.data();
+}
+
+const uint8_t* VecKontagionEnv::dones() const
+{
+    return m_dones.data();
+}
+
+const uint8_t* VecKontagionEnv::truncations() const
+{
+    return m_truncations.data();
+}
+
+const KontagionEnv& VecKontagionEnv::env(int i) const
+{
+    return *m_envs[i];
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  --env-bench
+///////////////////////////////////////////////////////////////////////////
+
+int runEnvBench(int argc, char* argv[])
+{
+    int envs = 16;
+    int threads = 0;
+    long long steps = 20000;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 == argc)
+        {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--envs")
+            envs = atoi(value);
+        else if (arg == "--threads")
+            threads = atoi(value);
+        else if (arg == "--steps")
+            steps = atoll(value);
+        else if (arg == "--seed")
+            seed = static_cast<unsigned int>(strtoul(value, nullptr, 10));
+        else
+        {
+            cout << "Unknown env-bench option " << arg << endl;
+            return 1;
+        }
+    }
+    if (envs <= 0  ||  steps <= 0)
+    {
+        cout << "--envs and --steps must be positive" << endl;
+        return 1;
+    }
+
+    VecKontagionEnv vec(envs, threads);
+    vector<int> actions(envs);
+    vector<double> returns(envs);
+    minstd_rand random(seed);
+    long long episodes = 0;
+    double totalReturn = 0;
+
+    vec.reset(seed);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (long long s = 0; s < steps; s++)
+    {
+        for (int& a : actions)
+            a = static_cast<int>(random() % KontagionEnv::NUM_ACTIONS);
+        vec.step(actions.data());
+        for (int i = 0; i < envs; i++)
+        {
+            returns[i] += vec.rewards()[i];
+            if (vec.dones()[i])
+            {
+                episodes++;
+                totalReturn += returns[i];
+                returns[i] = 0;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << envs << " environments on " << vec.threads() << " threads: " << steps * envs / seconds
+         << " steps/s (" << steps / seconds << " batches/s), " << episodes << " episodes finished";
+    if (episodes > 0)
+        cout << ", mean return " << totalReturn / episodes;
+    cout << endl;
+    return 0;
+}
@@ -0,0 +1,193 @@
+#ifndef KONTAGIONENV_H_
+#define KONTAGIONENV_H_
+
+#include "GraphObject.h"
+#include "OccupancyGrid.h"
+#include "InputPolicy.h"
+#include <random>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+class ActorWorld;
+
+  // What a step did to the game
+struct StepResult
+{
+    float reward;       // the points scored during the step
+    bool  done;         // the game is over, or the episode ran out of ticks
+    bool  truncated;    // done only because the episode ran out of ticks
+};
+
+  // The headless game as a training environment: reset(seed) starts a new
+  // game, then each step(action) presses one key for one tick and reports
+  // the reward and what Socrates can now see.  Deaths and finished levels are
+  // played through as GameController plays them, so an episode is a whole
+  // game, three lives long unless goodies add more.
+  //
+  // Each environment has its own random sequence and its own registry of
+  // objects, so a seeded episode plays the same whichever thread steps it
+  // and however many other environments are running beside it.  One thread
+  // at a time may use an environment.
+  //
+  // An observation is OBSERVATION_SIZE floats, about Socrates first:
+  //
+  //   cos and sin of the angle he faces, his health / 100, sprays / 20,
+  //   flames / 5, lives / 3 and level / 10
+  //
+  // and then NEAREST_ACTORS slots for the actors closest to him, nearest
+  // first, each of SLOT_SIZE floats:
+  //
+  //   1 if the slot is filled (the rest are 0 if not); how far the actor is
+  //   ahead of him and across to his left, and its distance, each over the
+  //   width of the dish; then 1 in the one of hostile (bacteria or fungus),
+  //   goodie, dirt or other (food or pit) that it is
+  //
+  // Sprays and flames in flight are left out.
+  //
+  // The world's occupancy grid is there too, for agents that would rather
+  // see the whole dish: occupancy() while a game is on, or copyOccupancy to
+  // copy all its layers out (OCCUPANCY_BYTES).
+
+class KontagionEnv
+{
+  public:
+    enum Action
+    {
+        ACTION_NONE,
+        ACTION_LEFT,        // KEY_PRESS_LEFT
+        ACTION_RIGHT,       // KEY_PRESS_RIGHT
+        ACTION_SPRAY,       // KEY_PRESS_SPACE
+        ACTION_FLAME,       // KEY_PRESS_ENTER
+        NUM_ACTIONS
+    };
+
+    static const int SOCRATES_FIELDS = 7;
+    static const int NEAREST_ACTORS = 32;
+    static const int SLOT_SIZE = 8;
+    static const int OBSERVATION_SIZE = SOCRATES_FIELDS + NEAREST_ACTORS * SLOT_SIZE;
+    static const int OCCUPANCY_BYTES = OccupancyGrid::SIZE * OccupancyGrid::SIZE * NUM_OCCUPANCY_LAYERS;
+
+      // An episode is cut short after episodeTicks steps, unless it is 0
+    explicit KontagionEnv(long long episodeTicks = 0);
+    ~KontagionEnv();
+
+    void reset(unsigned int seed, float* observation);
+    StepResult step(int action, float* observation);
+
+    int score() const;
+    int level() const;
+    int lives() const;
+    long long ticks() const;    // steps since the last reset
+    const OccupancyGrid* occupancy() const;     // nullptr once the game is over
+    void copyOccupancy(std::uint8_t* out) const;    // all zero once the game is over
+
+    KontagionEnv(const KontagionEnv&) = delete;
+    KontagionEnv& operator=(const KontagionEnv&) = delete;
+
+  private:
+    class Scope;
+
+      // Presses the key for the action being stepped
+    class ActionInput : public InputPolicy
+    {
+      public:
+        int key;
+        virtual bool nextKey(const ActorWorld& world, int& key);
+    };
+
+      // Declared before the world, which must go first
+    GraphObject::Registry       m_registry;
+    RandSequence                m_random;
+    ActionInput                 m_input;
+    std::unique_ptr<ActorWorld> m_world;
+    bool                        m_over;     // until the next reset
+    long long                   m_ticks;
+    long long                   m_episodeTicks;
+
+    void observe(float* observation) const;
+};
+
+  // K environments stepped in lockstep: step() hands each its action,
+  // spreads the work over worker threads (the calling thread takes a share
+  // too) and returns once every one has stepped.  Observations land in one
+  // contiguous buffer, environment i's at observations() + i *
+  // OBSERVATION_SIZE, beside arrays of rewards and done flags; nothing is
+  // allocated once construction is over.
+  //
+  // An environment that finishes its episode is reset at once, with the
+  // next seed in its sequence, so the observation returned with done set is
+  // already the first of the next episode, as vectorized gym environments
+  // do it.
+  //
+  // If asked for, each environment's occupancy grid is copied after every
+  // step into a second contiguous buffer, OCCUPANCY_BYTES apiece.
+
+class VecKontagionEnv
+{
+  public:
+      // threads 0 means one per core, but never more than there are
+      // environments
+    VecKontagionEnv(int numEnvs, int threads = 0, long long episodeTicks = 0, bool withOccupancy = false);
+    ~VecKontagionEnv();
+
+      // Environment i starts from seed + i, and each later episode it plays
+      // from seed + i + numEnvs * episodes so far
+    void reset(unsigned int seed);
+    void step(const int* actions);
+
+    int size() const;
+    int threads() const;
+    const float* observations() const;
+    const std::uint8_t* occupancies() const;    // nullptr unless asked for
+    const float* rewards() const;
+    const std::uint8_t* dones() const;
+    const std::uint8_t* truncations() const;
+    const KontagionEnv& env(int i) const;
+
+    VecKontagionEnv(const VecKontagionEnv&) = delete;
+    VecKontagionEnv& operator=(const VecKontagionEnv&) = delete;
+
+  private:
+    enum Job { JOB_NONE, JOB_RESET, JOB_STEP, JOB_QUIT };
+
+    std::vector<std::unique_ptr<KontagionEnv>> m_envs;
+    std::vector<float>          m_observations;
+    std::vector<std::uint8_t>   m_occupancies;
+    std::vector<float>          m_rewards;
+    std::vector<std::uint8_t>   m_dones;
+    std::vector<std::uint8_t>   m_truncations;
+    std::vector<unsigned int>   m_nextSeeds;
+    unsigned int                m_seedStride;
+
+    std::vector<std::thread>    m_workers;
+    std::mutex                  m_lock;
+    std::condition_variable     m_wake;
+    std::condition_variable     m_finished;
+    Job                         m_job;
+    const int*                  m_actions;
+    unsigned long long          m_generation;   // bumped for every job
+    int                         m_busy;         // workers still on this job
+
+    void runJob(Job job);
+    void doShare(int share, Job job);
+    void workerLoop(int share);
+    void resetEnv(int i);
+};
+
+  // Kontagion --env-bench [options] steps a VecKontagionEnv with random
+  // actions and reports steps per second:
+  //
+  //   --envs N      environments (default 16)
+  //   --threads N   worker threads, 0 for one per core (default 0)
+  //   --steps N     steps of the whole batch (default 20000)
+  //   --seed N      (default 1)
+  //
+  // argc and argv cover only the arguments after --env-bench.
+
+int runEnvBench(int argc, char* argv[]);
+
+#endif // KONTAGIONENV_H_
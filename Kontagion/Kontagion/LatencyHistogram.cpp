@@ -0,0 +1,123 @@
+#include "LatencyHistogram.h"
+#include <iomanip>
+#include <cmath>
+using namespace std;
+
+LatencyHistogram::LatencyHistogram()
+ : m_total(0), m_max(0), m_sum(0)
+{
+    for (atomic<unsigned long long>& c : m_counts)
+        c.store(0, memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketOf(long long ns)
+{
+    if (ns < 2 * SUB_BUCKETS)
+        return ns < 0 ? 0 : static_cast<int>(ns);
+    int magnitude = 0;
+    for (unsigned long long v = static_cast<unsigned long long>(ns); v >= 2 * SUB_BUCKETS; v >>= 1)
+        magnitude++;
+    int bucket = (magnitude + 1) * SUB_BUCKETS + static_cast<int>(ns >> magnitude) - SUB_BUCKETS;
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+long long LatencyHistogram::highestIn(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+        return bucket;
+    int magnitude = bucket / SUB_BUCKETS - 1;
+    long long sub = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << magnitude) - 1;
+}
+
+void LatencyHistogram::record(long long ns)
+{
+      // Only one thread records, so plain loads and stores are enough; they
+      // are atomic just so readers on other threads see whole values
+    atomic<unsigned long long>& c = m_counts[bucketOf(ns)];
+    c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    m_sum.store(m_sum.load(memory_order_relaxed) + ns, memory_order_relaxed);
+    if (ns > m_max.load(memory_order_relaxed))
+        m_max.store(ns, memory_order_relaxed);
+    m_total.store(m_total.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+unsigned long long LatencyHistogram::count() const
+{
+    return m_total.load(memory_order_relaxed);
+}
+
+long long LatencyHistogram::max() const
+{
+    return m_max.load(memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    unsigned long long n = count();
+    return n == 0 ? 0 : m_sum.load(memory_order_relaxed) / n;
+}
+
+long long LatencyHistogram::percentile(double fraction) const
+{
+    unsigned long long n = count();
+    if (n == 0)
+        return 0;
+    unsigned long long wanted = static_cast<unsigned long long>(ceil(fraction * n));
+    if (wanted < 1)
+        wanted = 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < NUM_BUCKETS; b++)
+    {
+        seen += m_counts[b].load(memory_order_relaxed);
+        if (seen >= wanted)
+            return std::min(highestIn(b), max());
+    }
+    return max();
+}
+
+unsigned long long LatencyHistogram::countAbove(long long ns) const
+{
+      // Whole buckets only: the one that holds ns counts as not above it
+    unsigned long long above = 0;
+    for (int b = bucketOf(ns) + 1; b < NUM_BUCKETS; b++)
+        above += m_counts[b].load(memory_order_relaxed);
+    return above;
+}
+
+void LatencyHistogram::writePercentiles(ostream& out) const
+{
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    unsigned long long n = count();
+    double meanUs = mean() / 1e3;
+    double squares = 0;
+    out << setw(12) << "Value" << setw(15) << "Percentile" << setw(11) << "TotalCount"
+        << setw(17) << "1/(1-Percentile)" << "\n\n" << fixed;
+    unsigned long long seen = 0;
+    for (int b = 0; b < NUM_BUCKETS  &&  n > 0; b++)
+    {
+        unsigned long long c = m_counts[b].load(memory_order_relaxed);
+        if (c == 0)
+            continue;
+        seen += c;
+        double valueUs = std::min(highestIn(b), max()) / 1e3;
+        squares += c * (valueUs - meanUs) * (valueUs - meanUs);
+        double p = std::min(static_cast<double>(seen) / n, 1.0);
+        out << setw(12) << setprecision(3) << valueUs << " " << setprecision(12) << p
+            << setw(11) << seen;
+        if (p < 1)
+            out << setw(15) << setprecision(2) << 1 / (1 - p);
+        out << "\n";
+    }
+    out << setprecision(3)
+        << "#[Mean    = " << setw(12) << meanUs << ", StdDeviation   = " << setw(12)
+        << (n > 0 ? sqrt(squares / n) : 0) << "]\n"
+        << "#[Max     = " << setw(12) << max() / 1e3 << ", Total count    = " << setw(12) << n << "]\n"
+        << "#[Buckets = " << setw(12) << NUM_BUCKETS / SUB_BUCKETS << ", SubBuckets     = " << setw(12)
+        << SUB_BUCKETS << "]\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,50 @@
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include <ostream>
+
+  // A histogram of durations in nanoseconds, bucketed the way HdrHistogram
+  // does it: exact below 128 ns, then 64 buckets per power of two, so any
+  // recorded value is known to within 1.6% whether it was a microsecond or a
+  // minute.  Memory is fixed and recording never allocates.
+  //
+  // One thread records; any thread may read the counts at the same time and
+  // will see a view that is at most a few samples behind.
+
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram();
+
+    void record(long long ns);
+
+    unsigned long long count() const;
+    long long max() const;
+    double mean() const;
+
+      // The smallest value that at least fraction (0 to 1) of the samples
+      // are no greater than, to within the bucket's precision
+    long long percentile(double fraction) const;
+
+      // How many samples exceeded ns
+    unsigned long long countAbove(long long ns) const;
+
+      // The percentile distribution in HdrHistogram's text format (.hgrm),
+      // which its online plotter reads, with values in microseconds
+    void writePercentiles(std::ostream& out) const;
+
+  private:
+    static const int SUB_BUCKETS = 64;
+    static const int NUM_BUCKETS = 2 * SUB_BUCKETS + 40 * SUB_BUCKETS;
+
+    std::atomic<unsigned long long> m_counts[NUM_BUCKETS];
+    std::atomic<unsigned long long> m_total;
+    std::atomic<long long>          m_max;
+    std::atomic<double>             m_sum;
+
+    static int bucketOf(long long ns);
+    static long long highestIn(int bucket);
+};
+
+#endif // LATENCYHISTOGRAM_H_
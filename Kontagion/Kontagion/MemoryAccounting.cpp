@@ -0,0 +1,127 @@
+#include "MemoryAccounting.h"
+#include "GraphObject.h"
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+  // What a node costs in a std::list<Actor*> and a std::set<GraphObject*>
+  // in the usual implementations: the links, plus the colour for the set
+static const size_t LIST_NODE_BYTES = 3 * sizeof(void*);
+static const size_t SET_NODE_BYTES = 4 * sizeof(void*) + sizeof(GraphObject*);
+
+static double kilobytes(size_t bytes)
+{
+    return bytes / 1024.0;
+}
+
+MemoryAccounting::MemoryAccounting()
+ : m_types(), m_liveActors(0), m_totalCreated(0), m_liveBytes(0), m_levelNumber(0), m_level(), m_run()
+{
+}
+
+void MemoryAccounting::sampleContainers(size_t actorListSize)
+{
+    size_t depthEntries = 0;
+    for (int depth = 0; depth < GraphObject::NUM_DEPTHS; depth++)
+        depthEntries += GraphObject::objectCount(depth);
+    m_level.listNodes = max(m_level.listNodes, actorListSize);
+    m_level.depthEntries = max(m_level.depthEntries, depthEntries);
+}
+
+void MemoryAccounting::beginLevel(int level)
+{
+    foldLevelIntoRun();
+    m_levelNumber = level;
+    m_level = Peaks();
+    m_level.actors = m_liveActors;
+    m_level.actorBytes = m_liveBytes;
+    for (TypeCounts& c : m_types)
+    {
+        c.levelPeak = c.live;
+        c.created = 0;
+    }
+}
+
+void MemoryAccounting::endLevel()
+{
+    foldLevelIntoRun();
+    for (TypeCounts& c : m_types)
+        c.created = 0;
+}
+
+bool MemoryAccounting::levelUsed() const
+{
+    for (const TypeCounts& c : m_types)
+        if (c.created > 0)
+            return true;
+    return false;
+}
+
+void MemoryAccounting::foldLevelIntoRun()
+{
+    m_run.actors = max(m_run.actors, m_level.actors);
+    m_run.actorBytes = max(m_run.actorBytes, m_level.actorBytes);
+    m_run.listNodes = max(m_run.listNodes, m_level.listNodes);
+    m_run.depthEntries = max(m_run.depthEntries, m_level.depthEntries);
+    for (TypeCounts& c : m_types)
+        c.runPeak = max(c.runPeak, c.levelPeak);
+}
+
+void MemoryAccounting::reportPeaks(ostream& out, const Peaks& peaks)
+{
+    out << fixed << setprecision(1) << "peak " << peaks.actors << " actors in "
+        << kilobytes(peaks.actorBytes) << " KB; actor list peak " << peaks.listNodes << " nodes ("
+        << kilobytes(peaks.listNodes * LIST_NODE_BYTES) << " KB); depth sets peak "
+        << peaks.depthEntries << " entries (" << kilobytes(peaks.depthEntries * SET_NODE_BYTES)
+        << " KB)" << defaultfloat << '\n';
+}
+
+void MemoryAccounting::reportLevel(ostream& out) const
+{
+    out << "Level " << m_levelNumber << " memory: ";
+    reportPeaks(out, m_level);
+    for (int t = 0; t < NUM_ACTOR_TYPES; t++)
+    {
+        const TypeCounts& c = m_types[t];
+        if (c.levelPeak == 0  &&  c.created == 0)
+            continue;
+        ActorType type = static_cast<ActorType>(t);
+        out << "  " << left << setw(22) << actorTypeName(type) << right << setw(6) << c.levelPeak
+            << " peak (" << actorTypeSize(type) << " bytes each, " << fixed << setprecision(1)
+            << kilobytes(c.levelPeak * actorTypeSize(type)) << " KB), " << defaultfloat << c.created
+            << " created\n";
+    }
+}
+
+bool MemoryAccounting::checkReleased(ostream& out) const
+{
+    bool released = (m_liveActors == 0);
+    for (int t = 0; t < NUM_ACTOR_TYPES; t++)
+        if (m_types[t].live != 0)
+            out << "  Still alive after cleanUp: " << m_types[t].live << ' '
+                << actorTypeName(static_cast<ActorType>(t)) << '\n';
+    for (int depth = 0; depth < GraphObject::NUM_DEPTHS; depth++)
+    {
+        size_t remaining = GraphObject::objectCount(depth);
+        if (remaining != 0)
+        {
+            out << "  Still drawn after cleanUp: " << remaining << " objects at depth " << depth << '\n';
+            released = false;
+        }
+    }
+    if (released)
+        out << "  cleanUp released every actor\n";
+    return released;
+}
+
+void MemoryAccounting::reportRun(ostream& out) const
+{
+    MemoryAccounting all = *this;
+    all.foldLevelIntoRun();
+    out << "Run memory: ";
+    reportPeaks(out, all.m_run);
+    for (int t = 0; t < NUM_ACTOR_TYPES; t++)
+        if (all.m_types[t].runPeak > 0)
+            out << "  " << left << setw(22) << actorTypeName(static_cast<ActorType>(t)) << right
+                << setw(6) << all.m_types[t].runPeak << " peak\n";
+}
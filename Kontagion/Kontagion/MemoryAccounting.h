@@ -0,0 +1,100 @@
+#ifndef MEMORYACCOUNTING_H_
+#define MEMORYACCOUNTING_H_
+
+#include "Actor.h"
+#include <cstddef>
+#include <algorithm>
+#include <ostream>
+
+  // Keeps count of the actors a world has alive, by concrete type, and of
+  // the containers that hold them, with high-water marks for the current
+  // level and for the whole run.  Bytes are the objects themselves plus an
+  // estimate of the container nodes; allocator overhead isn't included.
+class MemoryAccounting
+{
+  public:
+    MemoryAccounting();
+
+    void actorCreated(ActorType type)
+    {
+        TypeCounts& c = m_types[type];
+        c.live++;
+        c.created++;
+        c.levelPeak = std::max(c.levelPeak, c.live);
+        m_totalCreated++;
+        m_liveActors++;
+        m_liveBytes += actorTypeSize(type);
+        m_level.actors = std::max(m_level.actors, m_liveActors);
+        m_level.actorBytes = std::max(m_level.actorBytes, m_liveBytes);
+    }
+
+    void actorDestroyed(ActorType type)
+    {
+        m_types[type].live--;
+        m_liveActors--;
+        m_liveBytes -= actorTypeSize(type);
+    }
+
+      // Once a tick, note how big the actor list and the depth sets are
+    void sampleContainers(std::size_t actorListSize);
+
+      // Start the level's high-water marks afresh, and fold a finished
+      // level's into the run's
+    void beginLevel(int level);
+    void endLevel();
+
+    int liveActors() const
+    {
+        return m_liveActors;
+    }
+
+      // Every actor ever created, so a tick can tell whether it spawned any
+    long long totalCreated() const
+    {
+        return m_totalCreated;
+    }
+
+      // Whether anything was created since the level began (and hasn't
+      // been ended yet)
+    bool levelUsed() const;
+
+      // The level's peaks, by type
+    void reportLevel(std::ostream& out) const;
+
+      // Once everything should be gone: reports any actors or depth set
+      // entries that are still around and returns false if there were some
+    bool checkReleased(std::ostream& out) const;
+
+      // The whole run's peaks
+    void reportRun(std::ostream& out) const;
+
+  private:
+    struct TypeCounts
+    {
+        int       live;
+        int       levelPeak;
+        int       runPeak;
+        long long created;      // this level
+    };
+
+    struct Peaks
+    {
+        int         actors;
+        std::size_t actorBytes;
+        std::size_t listNodes;
+        std::size_t depthEntries;
+    };
+
+    TypeCounts  m_types[NUM_ACTOR_TYPES];
+    int         m_liveActors;
+    long long   m_totalCreated;
+    std::size_t m_liveBytes;
+    int         m_levelNumber;
+    Peaks       m_level;
+    Peaks       m_run;
+
+    void foldLevelIntoRun();
+    static void reportPeaks(std::ostream& out, const Peaks& peaks);
+};
+
+#endif // MEMORYACCOUNTING_H_
@@ -0,0 +1,40 @@
+#include "OccupancyGrid.h"
+#include <cstring>
+using namespace std;
+
+OccupancyGrid::OccupancyGrid()
+{
+    clear();
+}
+
+void OccupancyGrid::add(int layer, int cell)
+{
+    uint16_t count = ++m_counts[layer][cell];
+    m_layers[layer][cell] = static_cast<uint8_t>(count < 255 ? count : 255);
+    m_totals[layer]++;
+}
+
+void OccupancyGrid::remove(int layer, int cell)
+{
+    uint16_t count = --m_counts[layer][cell];
+    m_layers[layer][cell] = static_cast<uint8_t>(count < 255 ? count : 255);
+    m_totals[layer]--;
+}
+
+void OccupancyGrid::move(int layer, int fromCell, int toCell)
+{
+    remove(layer, fromCell);
+    add(layer, toCell);
+}
+
+void OccupancyGrid::clear()
+{
+    memset(m_layers, 0, sizeof(m_layers));
+    memset(m_counts, 0, sizeof(m_counts));
+    memset(m_totals, 0, sizeof(m_totals));
+}
+
+int OccupancyGrid::total(int layer) const
+{
+    return m_totals[layer];
+}
@@ -0,0 +1,72 @@
+#ifndef OCCUPANCYGRID_H_
+#define OCCUPANCYGRID_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+
+enum OccupancyLayer
+{
+    OCCUPANCY_HOSTILE,      // bacteria and fungi, as KontagionEnv's observations class them
+    OCCUPANCY_FOOD,
+    OCCUPANCY_DIRT,
+    OCCUPANCY_GOODIES,
+    NUM_OCCUPANCY_LAYERS
+};
+
+  // A coarse picture of the dish: for each layer, how many actors of that
+  // kind are in each cell of a SIZE by SIZE grid.  The world keeps it up to
+  // date as actors are added, move from one cell to another and are
+  // destroyed, so reading it costs nothing.
+  //
+  // Each layer is SIZE * SIZE bytes, a row at a time from the bottom of the
+  // dish (y = 0) up, the count in a cell stopping at 255; the layers follow
+  // each other in memory in OccupancyLayer order, so all of them can be
+  // handed on as one block of layerBytes() * NUM_OCCUPANCY_LAYERS.
+
+class OccupancyGrid
+{
+  public:
+    static const int SIZE = 64;
+    static const int CELL_WIDTH = VIEW_WIDTH / SIZE;
+
+    OccupancyGrid();
+
+      // The cell holding a point; points off the dish go in the nearest
+      // cell on its edge
+    static int cellOf(double x, double y)
+    {
+        return clampToGrid(y) * SIZE + clampToGrid(x);
+    }
+
+    void add(int layer, int cell);
+    void remove(int layer, int cell);
+    void move(int layer, int fromCell, int toCell);
+    void clear();
+
+    const std::uint8_t* layer(int layer) const
+    {
+        return m_layers[layer];
+    }
+    const std::uint8_t* layers() const
+    {
+        return m_layers[0];
+    }
+    static int layerBytes()
+    {
+        return SIZE * SIZE;
+    }
+    int total(int layer) const;     // actors counted on the layer
+
+  private:
+    std::uint8_t  m_layers[NUM_OCCUPANCY_LAYERS][SIZE * SIZE];
+    std::uint16_t m_counts[NUM_OCCUPANCY_LAYERS][SIZE * SIZE];     // unclamped
+    int           m_totals[NUM_OCCUPANCY_LAYERS];
+
+    static int clampToGrid(double coordinate)
+    {
+        int cell = static_cast<int>(coordinate) / CELL_WIDTH;
+        return cell < 0 ? 0 : (cell >= SIZE ? SIZE - 1 : cell);
+    }
+};
+
+#endif // OCCUPANCYGRID_H_
@@ -0,0 +1,157 @@
+#include "PerfCounters.h"
+#include <cstring>
+#include <cerrno>
+using namespace std;
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+static const char* const COUNTER_NAMES[NUM_PERF_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+const char* perfCounterName(PerfCounterID id)
+{
+    return COUNTER_NAMES[id];
+}
+
+PerfCounters::PerfCounters()
+ : m_leader(-1), m_opened(0)
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        m_fds[i] = -1;
+        m_slot[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+#ifdef __linux__
+
+static void describeCounter(PerfCounterID id, perf_event_attr& attr)
+{
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    switch (id)
+    {
+        case COUNTER_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case COUNTER_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case COUNTER_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case COUNTER_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case COUNTER_BRANCH_MISSES:
+        default:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+}
+
+bool PerfCounters::open(string& whyNot)
+{
+    close();
+    int firstError = 0;
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        perf_event_attr attr;
+        describeCounter(static_cast<PerfCounterID>(i), attr);
+        attr.disabled = (m_leader == -1);   // the leader starts the whole group
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+        if (fd == -1)
+        {
+            if (firstError == 0)
+                firstError = errno;
+            continue;
+        }
+        if (m_leader == -1)
+            m_leader = fd;
+        m_fds[i] = fd;
+        m_slot[i] = m_opened++;
+    }
+
+    if (m_leader == -1)
+    {
+        whyNot = string("perf_event_open: ") + strerror(firstError);
+        if (firstError == EACCES  ||  firstError == EPERM)
+            whyNot += " (see /proc/sys/kernel/perf_event_paranoid)";
+        return false;
+    }
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close()
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (m_fds[i] != -1)
+            ::close(m_fds[i]);
+        m_fds[i] = -1;
+        m_slot[i] = -1;
+    }
+    m_leader = -1;
+    m_opened = 0;
+}
+
+bool PerfCounters::read(CounterSample& sample) const
+{
+    memset(&sample, 0, sizeof(sample));
+    if (m_leader == -1)
+        return false;
+
+      // One read returns the whole group: the count, then each value in the
+      // order the counters were opened
+    unsigned long long buffer[1 + NUM_PERF_COUNTERS];
+    ssize_t bytes = ::read(m_leader, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(sizeof(unsigned long long) * (1 + m_opened)))
+        return false;
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+        if (m_slot[i] != -1)
+            sample.values[i] = buffer[1 + m_slot[i]];
+    return true;
+}
+
+#else  // no perf_event_open
+
+bool PerfCounters::open(string& whyNot)
+{
+    whyNot = "hardware counters are only supported on Linux";
+    return false;
+}
+
+void PerfCounters::close()
+{
+}
+
+bool PerfCounters::read(CounterSample& sample) const
+{
+    memset(&sample, 0, sizeof(sample));
+    return false;
+}
+
+#endif
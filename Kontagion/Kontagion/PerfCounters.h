@@ -0,0 +1,60 @@
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include <string>
+
+  // Hardware performance counters for the calling thread, counted in user
+  // space only.  They come from perf_event_open, so they exist only on Linux,
+  // and only where the kernel and the machine allow it (not in many VMs, or
+  // with a strict /proc/sys/kernel/perf_event_paranoid).  Anything that can't
+  // be opened is simply missing; callers check has().
+
+enum PerfCounterID
+{
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    NUM_PERF_COUNTERS
+};
+
+const char* perfCounterName(PerfCounterID id);
+
+struct CounterSample
+{
+    unsigned long long values[NUM_PERF_COUNTERS];
+};
+
+class PerfCounters
+{
+  public:
+    PerfCounters();
+    ~PerfCounters();
+
+      // Returns false, with the reason in whyNot, if no counter could be opened
+    bool open(std::string& whyNot);
+    void close();
+    bool isOpen() const
+    {
+        return m_leader != -1;
+    }
+    bool has(PerfCounterID id) const
+    {
+        return m_slot[id] != -1;
+    }
+
+      // Running totals since open; counters that aren't available read as 0
+    bool read(CounterSample& sample) const;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+  private:
+    int m_leader;                       // the group leader's file descriptor
+    int m_fds[NUM_PERF_COUNTERS];
+    int m_slot[NUM_PERF_COUNTERS];      // position in a group read, or -1
+    int m_opened;
+};
+
+#endif // PERFCOUNTERS_H_
@@ -0,0 +1,54 @@
+#include "ProcessStats.h"
+
+#if defined(__linux__)
+#include <fstream>
+#include <unistd.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+
+bool residentSetBytes(std::size_t& bytes)
+{
+#if defined(__linux__)
+      // statm: total program size, then resident pages
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size, pages;
+    if (!(statm >> size >> pages))
+        return false;
+    bytes = pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return true;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return false;
+    bytes = info.resident_size;
+    return true;
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+bool heapStats(HeapStats& stats)
+{
+#if defined(__GLIBC__)  &&  (__GLIBC__ > 2  ||  (__GLIBC__ == 2  &&  __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    stats.arenaBytes = info.arena;
+    stats.inUseBytes = info.uordblks + info.hblkhd;
+    stats.freeBytes = info.fordblks;
+    return true;
+#elif defined(__APPLE__)
+    malloc_statistics_t info;
+    malloc_zone_statistics(nullptr, &info);
+    stats.arenaBytes = info.size_allocated;
+    stats.inUseBytes = info.size_in_use;
+    stats.freeBytes = info.size_allocated - info.size_in_use;
+    return true;
+#else
+    (void)stats;
+    return false;
+#endif
+}
@@ -0,0 +1,26 @@
+#ifndef PROCESSSTATS_H_
+#define PROCESSSTATS_H_
+
+#include <cstddef>
+
+  // What the operating system and the C allocator say about this process's
+  // memory.  Each returns false where the platform can't tell.
+
+bool residentSetBytes(std::size_t& bytes);
+
+struct HeapStats
+{
+    std::size_t arenaBytes;     // obtained from the system for the heap
+    std::size_t inUseBytes;     // handed out to the program
+    std::size_t freeBytes;      // held by the allocator but free
+
+      // The share of the heap that is free but can't be handed back
+    double fragmentation() const
+    {
+        return arenaBytes == 0 ? 0 : static_cast<double>(freeBytes) / arenaBytes;
+    }
+};
+
+bool heapStats(HeapStats& stats);
+
+#endif // PROCESSSTATS_H_
@@ -0,0 +1,405 @@
+#include "Replay.h"
+#include "ActorWorld.h"
+#include "GameController.h"
+#include "GraphObject.h"
+#include "GameConstants.h"
+#include "StateHash.h"
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+using namespace std;
+
+namespace {
+
+const char REPLAY_MAGIC[4] = { 'K', 'T', 'R', 'P' };
+
+unsigned long long zigzag(long long value)
+{
+    return (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63);
+}
+
+long long unzigzag(unsigned long long value)
+{
+    return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+}
+
+  // Reads a varint from [p, end), or returns false if it runs off the end
+bool readVarint(const unsigned char*& p, const unsigned char* end, unsigned long long& value)
+{
+    value = 0;
+    for (int shift = 0; p != end  &&  shift < 64; shift += 7)
+    {
+        unsigned char byte = *p++;
+        value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+  // The watched session ends where the recording did, rather than leaving
+  // Socrates standing idle until the bacteria get him
+class Watcher : public InputPolicy
+{
+  public:
+    ReplayPlayer    player;
+    GameController* controller = nullptr;
+
+    virtual bool nextKey(const ActorWorld& world, int& key)
+    {
+        if (world.ticks() > player.lastTick())
+        {
+            controller->quitGame();
+            return false;
+        }
+        return player.nextKey(world, key);
+    }
+};
+
+ReplayRecorder& sessionRecorder()
+{
+    static ReplayRecorder recorder;     // outlives the world that reports to it
+    return recorder;
+}
+
+Watcher& sessionWatcher()
+{
+    static Watcher watcher;
+    return watcher;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////
+// ReplayRecorder
+/////////////////////////////////////////////////////////////////
+
+ReplayRecorder::ReplayRecorder()
+ : m_lastTick(0), m_finished(false)
+{}
+
+bool ReplayRecorder::open(const string& path, unsigned int seed)
+{
+    m_out.open(path, ios::binary | ios::trunc);
+    if (!m_out)
+        return false;
+    m_out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    m_out.put(static_cast<char>(REPLAY_VERSION));
+    for (int i = 0; i < 4; i++)
+        m_out.put(static_cast<char>((seed >> (8 * i)) & 0xff));
+    m_out.flush();
+    m_lastTick = 0;
+    m_finished = false;
+    return static_cast<bool>(m_out);
+}
+
+bool ReplayRecorder::isOpen() const
+{
+    return m_out.is_open();
+}
+
+void ReplayRecorder::record(long long tick, int key)
+{
+    if (!m_out.is_open()  ||  m_finished  ||  key == 0)
+        return;
+    writeVarint(static_cast<unsigned long long>(tick - m_lastTick));
+    writeVarint(static_cast<unsigned long long>(key));
+    m_lastTick = tick;
+
+      // A press is a few bytes every few ticks, and a log that survives a
+      // crash is the one most worth having
+    m_out.flush();
+}
+
+void ReplayRecorder::finish(long long tick, int score, int level, int lives)
+{
+    if (!m_out.is_open()  ||  m_finished)
+        return;
+    writeVarint(static_cast<unsigned long long>(tick - m_lastTick));
+    writeVarint(0);
+    writeVarint(zigzag(score));
+    writeVarint(static_cast<unsigned long long>(level));
+    writeVarint(static_cast<unsigned long long>(lives));
+    m_out.flush();
+    m_finished = true;
+}
+
+void ReplayRecorder::writeVarint(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        m_out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    m_out.put(static_cast<char>(value));
+}
+
+/////////////////////////////////////////////////////////////////
+// ReplayPlayer
+/////////////////////////////////////////////////////////////////
+
+ReplayPlayer::ReplayPlayer()
+ : m_next(0), m_seed(0), m_lastTick(0), m_hasEnding(false), m_endScore(0), m_endLevel(0), m_endLives(0)
+{}
+
+bool ReplayPlayer::load(const string& path)
+{
+    m_keys.clear();
+    m_next = 0;
+    m_lastTick = 0;
+    m_hasEnding = false;
+
+    ifstream in(path, ios::binary);
+    if (!in)
+    {
+        m_error = "Cannot read " + path;
+        return false;
+    }
+    vector<unsigned char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    const size_t headerSize = sizeof(REPLAY_MAGIC) + 1 + 4;
+    if (bytes.size() < headerSize  ||  !equal(begin(REPLAY_MAGIC), end(REPLAY_MAGIC), bytes.begin()))
+    {
+        m_error = path + " is not a Kontagion replay";
+        return false;
+    }
+    if (bytes[sizeof(REPLAY_MAGIC)] != REPLAY_VERSION)
+    {
+        m_error = path + " is a version " + to_string(bytes[sizeof(REPLAY_MAGIC)]) +
+                  " replay; this build plays version " + to_string(REPLAY_VERSION);
+        return false;
+    }
+    m_seed = 0;
+    for (int i = 0; i < 4; i++)
+        m_seed |= static_cast<unsigned int>(bytes[sizeof(REPLAY_MAGIC) + 1 + i]) << (8 * i);
+
+    const unsigned char* p = bytes.data() + headerSize;
+    const unsigned char* end = bytes.data() + bytes.size();
+    while (p != end)
+    {
+        unsigned long long delta, key;
+        if (!readVarint(p, end, delta)  ||  !readVarint(p, end, key))
+            break;      // cut off mid-record
+        m_lastTick += static_cast<long long>(delta);
+        if (key != 0)
+        {
+            m_keys.push_back(KeyPress{ m_lastTick, static_cast<int>(key) });
+            continue;
+        }
+        unsigned long long score, level, lives;
+        if (readVarint(p, end, score)  &&  readVarint(p, end, level)  &&  readVarint(p, end, lives))
+        {
+            m_hasEnding = true;
+            m_endScore = static_cast<int>(unzigzag(score));
+            m_endLevel = static_cast<int>(level);
+            m_endLives = static_cast<int>(lives);
+        }
+        break;
+    }
+    if (!m_hasEnding)
+        m_lastTick = (m_keys.empty() ? 0 : m_keys.back().tick);
+    m_error.clear();
+    return true;
+}
+
+const string& ReplayPlayer::error() const
+{
+    return m_error;
+}
+
+void ReplayPlayer::rewind()
+{
+    m_next = 0;
+}
+
+unsigned int ReplayPlayer::seed() const
+{
+    return m_seed;
+}
+
+size_t ReplayPlayer::keyPresses() const
+{
+    return m_keys.size();
+}
+
+long long ReplayPlayer::lastTick() const
+{
+    return m_lastTick;
+}
+
+bool ReplayPlayer::hasEnding() const
+{
+    return m_hasEnding;
+}
+
+int ReplayPlayer::endScore() const
+{
+    return m_endScore;
+}
+
+int ReplayPlayer::endLevel() const
+{
+    return m_endLevel;
+}
+
+int ReplayPlayer::endLives() const
+{
+    return m_endLives;
+}
+
+bool ReplayPlayer::nextKey(const ActorWorld& world, int& key)
+{
+      // Socrates doesn't ask on the ticks he is dead, so skip any presses
+      // that can no longer come due (there are none in a faithful replay)
+    long long tick = world.ticks();
+    while (m_next < m_keys.size()  &&  m_keys[m_next].tick < tick)
+        m_next++;
+    if (m_next == m_keys.size()  ||  m_keys[m_next].tick != tick)
+        return false;
+    key = m_keys[m_next++].key;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////
+// Playback
+/////////////////////////////////////////////////////////////////
+
+int runReplay(int argc, char* argv[])
+{
+    if (argc < 1)
+    {
+        cout << "Usage: Kontagion --replay FILE [--repeat N]" << endl;
+        return 1;
+    }
+    string path = argv[0];
+    int repeat = 1;
+    string hashPath;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--repeat"  &&  i + 1 < argc)
+            repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--hashes"  &&  i + 1 < argc)
+            hashPath = argv[++i];
+        else
+        {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    ReplayPlayer player;
+    if (!player.load(path))
+    {
+        cout << player.error() << endl;
+        return 1;
+    }
+    cout << path << ": seed " << player.seed() << ", " << player.keyPresses() << " key presses over "
+         << player.lastTick() << " ticks" << (player.hasEnding() ? "" : " (no ending recorded)") << endl;
+
+    StateHashWriter hashes;
+    if (!hashPath.empty()  &&  !hashes.open(hashPath))
+    {
+        cout << "Cannot write " << hashPath << endl;
+        return 1;
+    }
+
+    bool allMatched = true;
+    for (int run = 1; run <= repeat; run++)
+    {
+        seedRandInt(player.seed());
+        player.rewind();
+        unique_ptr<ActorWorld> world(new ActorWorld(""));
+        world->reportMemoryTo(nullptr);
+        world->watchdog().configure(0, 1);
+        world->setInputPolicy(&player);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        world->init();
+        while (world->ticks() < player.lastTick())
+        {
+            GraphObject::beginTick();
+            int status = world->move();
+            world->flushSounds();
+            if (run == 1)
+                hashes.writeTick(*world);
+
+              // The same transitions GameController makes
+            RunOutcome outcome = world->endRun(status);
+            if (outcome == RUN_GAME_OVER)
+                break;
+            if (outcome != RUN_CONTINUES  &&  world->ticks() < player.lastTick())
+            {
+                world->cleanUp();
+                world->init();
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long ticks = world->ticks();
+        cout << "play " << run << ": " << ticks << " ticks in " << seconds << " s, "
+             << ticks / seconds << " ticks/s, " << ticks * MS_PER_TICK / 1000.0 / seconds
+             << "x real time; score " << world->getScore() << ", level " << world->getLevel()
+             << ", lives " << world->getLives() << endl;
+
+        if (player.hasEnding()  &&  (ticks != player.lastTick()  ||  world->getScore() != player.endScore()  ||
+                                      world->getLevel() != player.endLevel()  ||  world->getLives() != player.endLives()))
+        {
+            cout << "  DIVERGED: recorded " << player.lastTick() << " ticks, score " << player.endScore()
+                 << ", level " << player.endLevel() << ", lives " << player.endLives() << endl;
+            allMatched = false;
+        }
+    }
+    if (player.hasEnding())
+        cout << (allMatched ? "Replay matched the recording" : "Replay DIVERGED from the recording") << endl;
+    return allMatched ? 0 : 1;
+}
+
+bool prepareSession(int& argc, char**& argv, GameWorld* world, GameController& controller)
+{
+    if (argc < 3)
+        return true;
+    string mode = argv[1];
+    if (mode != "--record"  &&  mode != "--watch")
+        return true;
+    string path = argv[2];
+    int consumed = 2;
+    double speed = 4;
+    if (mode == "--watch"  &&  argc >= 5  &&  string(argv[3]) == "--speed")
+    {
+        speed = atof(argv[4]);
+        consumed += 2;
+    }
+    argv[consumed] = argv[0];
+    argc -= consumed;
+    argv += consumed;
+
+    ActorWorld* actorWorld = static_cast<ActorWorld*>(world);
+    if (mode == "--record")
+    {
+        if (!sessionRecorder().open(path, controller.randomSeed()))
+        {
+            cout << "Cannot write " << path << endl;
+            return false;
+        }
+        actorWorld->recordInputTo(&sessionRecorder());
+        cout << "Recording to " << path << " with seed " << controller.randomSeed() << endl;
+        return true;
+    }
+
+    Watcher& watcher = sessionWatcher();
+    if (!watcher.player.load(path))
+    {
+        cout << watcher.player.error() << endl;
+        return false;
+    }
+    watcher.controller = &controller;
+    controller.setRandomSeed(watcher.player.seed());
+    controller.setPlaybackSpeed(speed);
+    controller.setSkipPrompts(true);
+    actorWorld->setInputPolicy(&watcher);
+    return true;
+}
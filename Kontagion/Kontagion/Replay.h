@@ -0,0 +1,114 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "InputPolicy.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+class GameWorld;
+class GameController;
+
+  // A recorded session is its random seed and the keys Socrates acted on,
+  // each with the tick it was pressed on.  Given the same seed the game
+  // makes the same choices, so playing the keys back on the same ticks
+  // plays the session again exactly: a slow or buggy one from a field
+  // report can be watched, timed or profiled at leisure.
+  //
+  // The log is small enough to leave on.  After a header of "KTRP", a
+  // version byte and the seed (4 bytes, little-endian) come the key
+  // presses, each as two unsigned LEB128 varints: the ticks since the last
+  // press, then the key.  The log ends with a record whose key is 0: the
+  // ticks to the session's last tick, then its score (zigzag-encoded),
+  // level and lives there, so that playback can check it ended the same
+  // way.  A log cut short by a crash has no end record, and plays up to its
+  // last key press.
+
+const int REPLAY_VERSION = 1;
+
+class ReplayRecorder
+{
+  public:
+    ReplayRecorder();
+
+    bool open(const std::string& path, unsigned int seed);
+    bool isOpen() const;
+
+      // Ticks count from 1, the first move of the session
+    void record(long long tick, int key);
+    void finish(long long tick, int score, int level, int lives);
+
+  private:
+    std::ofstream m_out;
+    long long     m_lastTick;
+    bool          m_finished;
+
+    void writeVarint(unsigned long long value);
+};
+
+  // Presses the recorded keys on their ticks, for the world it is given to
+  // with ActorWorld::setInputPolicy.  The world has to be a fresh one, with
+  // the random numbers seeded with seed().
+class ReplayPlayer : public InputPolicy
+{
+  public:
+    ReplayPlayer();
+
+    bool load(const std::string& path);     // false, with the reason in error(), if unreadable
+    const std::string& error() const;
+    void rewind();                          // to play again in a fresh world
+
+    unsigned int seed() const;
+    size_t keyPresses() const;
+    long long lastTick() const;             // of the session, or of the last key if it didn't end cleanly
+    bool hasEnding() const;
+    int endScore() const;
+    int endLevel() const;
+    int endLives() const;
+
+    virtual bool nextKey(const ActorWorld& world, int& key);
+
+  private:
+    struct KeyPress
+    {
+        long long tick;
+        int       key;
+    };
+    std::vector<KeyPress> m_keys;
+    size_t       m_next;
+    unsigned int m_seed;
+    long long    m_lastTick;
+    bool         m_hasEnding;
+    int          m_endScore;
+    int          m_endLevel;
+    int          m_endLives;
+    std::string  m_error;
+};
+
+  // Kontagion --replay FILE [options] plays a recorded session again
+  // headless, as fast as it will go, reports how much faster than real
+  // time that was, and checks that it ended with the recorded score, level
+  // and lives:
+  //
+  //   --repeat N    plays it N times, e.g. for a profiler (default 1)
+  //   --hashes FILE writes the world's state hash after every tick of the
+  //                 first play to FILE, for --hash-diff (slows the play)
+  //
+  // argc and argv cover only the arguments after --replay.  Returns 0 if
+  // every play ended as recorded (or the log has no ending to check), 1
+  // otherwise.
+
+int runReplay(int argc, char* argv[]);
+
+  // For the game itself: consumes a leading
+  //
+  //   --record FILE               to record the session to FILE, or
+  //   --watch FILE [--speed X]    to watch FILE played back, X times as
+  //                               fast as real time (default 4)
+  //
+  // from argc and argv, setting up world and controller to match.  Returns
+  // false, having said why, if the file can't be opened or read.
+
+bool prepareSession(int& argc, char**& argv, GameWorld* world, GameController& controller);
+
+#endif // REPLAY_H_
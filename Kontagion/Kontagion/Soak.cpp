@@ -0,0 +1,333 @@
+#include "Soak.h"
+#include "ActorWorld.h"
+#include "GraphObject.h"
+#include "AllocCounter.h"
+#include "ProcessStats.h"
+#include "HeuristicBot.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+using namespace std;
+
+namespace {
+
+struct SoakOptions
+{
+    long long ticks = 2000000;
+    long long sampleEvery = 20000;
+    long long maxLevelTicks = 100000;
+    int       levels = 10;
+    unsigned  seed = 1;
+    double    maxRssGrowthMb = 16;
+    long long maxLeaked = 16;
+    double    maxSlowdown = 25;
+    string    outPath = "kontagion-soak.csv";
+};
+
+  // Samples and level boundaries before this many are still warming up
+  // (caches, the allocator's arenas, the first big levels) and set the
+  // baselines instead of being checked against them
+const int SETTLE_SAMPLES = 3;
+const int SETTLE_LEVELS = 5;
+
+  // A level's throughput is only compared once it has been played for this
+  // many ticks in both the first and the last quarter of the run
+const long long MIN_COMPARED_TICKS = 2000;
+
+struct SoakSample
+{
+    long long   tick;
+    double      seconds;
+    double      ticksPerSec;
+    size_t      rssBytes;
+    HeapStats   heap;
+    long long   liveAllocations;
+    int         actors;
+    int         level;
+    int         games;
+    int         levelsFinished;
+};
+
+  // Time spent ticking one level, in the first ([0]) and last ([1])
+  // quarters of the run
+struct LevelThroughput
+{
+    long long ticks[2] = { 0, 0 };
+    double    seconds[2] = { 0, 0 };
+};
+
+long long liveAllocations()
+{
+    return static_cast<long long>(allocationCount() - deallocationCount());
+}
+
+bool parseOptions(int argc, char* argv[], SoakOptions& options)
+{
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 == argc)
+        {
+            cout << "Missing value for " << arg << endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--ticks")
+            options.ticks = atoll(value);
+        else if (arg == "--sample-every")
+            options.sampleEvery = atoll(value);
+        else if (arg == "--max-level-ticks")
+            options.maxLevelTicks = atoll(value);
+        else if (arg == "--levels")
+            options.levels = atoi(value);
+        else if (arg == "--seed")
+            options.seed = static_cast<unsigned>(strtoul(value, nullptr, 10));
+        else if (arg == "--max-rss-growth")
+            options.maxRssGrowthMb = atof(value);
+        else if (arg == "--max-leaked")
+            options.maxLeaked = atoll(value);
+        else if (arg == "--max-slowdown")
+            options.maxSlowdown = atof(value);
+        else if (arg == "--out")
+            options.outPath = value;
+        else
+        {
+            cout << "Unknown soak option " << arg << endl;
+            return false;
+        }
+    }
+    if (options.ticks <= 0  ||  options.sampleEvery <= 0  ||  options.maxLevelTicks <= 0  ||  options.levels <= 0)
+    {
+        cout << "--ticks, --sample-every, --max-level-ticks and --levels must be positive" << endl;
+        return false;
+    }
+    return true;
+}
+
+void writeSample(ostream& out, const SoakSample& s)
+{
+    out << s.tick << ',' << s.seconds << ',' << s.ticksPerSec << ',' << s.rssBytes / 1024 << ','
+        << s.heap.arenaBytes / 1024 << ',' << s.heap.inUseBytes / 1024 << ','
+        << s.heap.fragmentation() << ',' << s.liveAllocations << ',' << s.actors << ','
+        << s.level << ',' << s.games << ',' << s.levelsFinished << '\n';
+}
+
+void printSample(const SoakSample& s)
+{
+    streamsize precision = cout.precision();
+    cout << fixed << setprecision(0) << "tick " << s.tick << ": " << s.ticksPerSec << " ticks/s, rss "
+         << s.rssBytes / 1024 << " KB, heap " << s.heap.inUseBytes / 1024 << " KB in use ("
+         << setprecision(1) << 100 * s.heap.fragmentation() << "% free), " << s.liveAllocations
+         << " live allocations, " << s.actors << " actors, level " << s.level << ", game "
+         << s.games << defaultfloat << setprecision(precision) << endl;
+}
+
+  // The tolerances, checked once the run is over
+bool judge(const vector<SoakSample>& samples, const vector<long long>& betweenLevels,
+           const map<int, LevelThroughput>& byLevel, const SoakOptions& options)
+{
+    bool ok = true;
+
+    if (samples.size() > SETTLE_SAMPLES  &&  samples[SETTLE_SAMPLES - 1].rssBytes > 0)
+    {
+        size_t baseline = samples[SETTLE_SAMPLES - 1].rssBytes;
+        size_t peak = baseline;
+        for (size_t i = SETTLE_SAMPLES; i < samples.size(); i++)
+            peak = max(peak, samples[i].rssBytes);
+        double growthMb = (static_cast<double>(peak) - baseline) / (1024 * 1024);
+        cout << "Resident memory grew " << growthMb << " MB after settling";
+        if (growthMb > options.maxRssGrowthMb)
+        {
+            cout << ": FAILED, more than " << options.maxRssGrowthMb << " MB";
+            ok = false;
+        }
+        cout << endl;
+    }
+    else
+        cout << "Too few samples to judge resident memory" << endl;
+
+      // Between levels the world is empty, so whatever is still allocated
+      // then should stay put
+    if (betweenLevels.size() > SETTLE_LEVELS)
+    {
+        long long baseline = *max_element(betweenLevels.begin(), betweenLevels.begin() + SETTLE_LEVELS);
+        long long peak = *max_element(betweenLevels.begin() + SETTLE_LEVELS, betweenLevels.end());
+        cout << "Live allocations between levels: " << baseline << " after settling, at most " << peak
+             << " later (" << betweenLevels.size() << " levels)";
+        if (peak - baseline > options.maxLeaked)
+        {
+            cout << ": FAILED, more than " << options.maxLeaked << " leaked";
+            ok = false;
+        }
+        cout << endl;
+    }
+    else
+        cout << "Too few levels played to judge leaks" << endl;
+
+      // Higher levels are slower to tick, and which levels the bot is on
+      // late in the run is down to chance, so each level is compared only
+      // with itself.  The verdict is on the mean slowdown, weighted by how
+      // long each level was played.
+    double weightedSlowdown = 0;
+    double weights = 0;
+    for (const auto& entry : byLevel)
+    {
+        const LevelThroughput& t = entry.second;
+        if (t.ticks[0] < MIN_COMPARED_TICKS  ||  t.ticks[1] < MIN_COMPARED_TICKS)
+            continue;
+        double early = t.ticks[0] / t.seconds[0];
+        double late = t.ticks[1] / t.seconds[1];
+        double slowdown = 100 * (early - late) / early;
+        double weight = static_cast<double>(min(t.ticks[0], t.ticks[1]));
+        weightedSlowdown += weight * slowdown;
+        weights += weight;
+        cout << "Level " << entry.first << ": " << early << " ticks/s in the first quarter, " << late
+             << " in the last (" << slowdown << "% slower)" << endl;
+    }
+    if (weights > 0)
+    {
+        double slowdown = weightedSlowdown / weights;
+        cout << "Throughput: " << slowdown << "% slower, level for level";
+        if (slowdown > options.maxSlowdown)
+        {
+            cout << ": FAILED, more than " << options.maxSlowdown << "%";
+            ok = false;
+        }
+        cout << endl;
+    }
+    else
+        cout << "No level was played long enough early and late to judge throughput" << endl;
+
+    return ok;
+}
+
+}  // namespace
+
+int runSoak(int argc, char* argv[])
+{
+    SoakOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    ofstream csv(options.outPath);
+    if (!csv)
+    {
+        cout << "Cannot write " << options.outPath << endl;
+        return 1;
+    }
+    csv << "tick,seconds,ticks_per_sec,rss_kb,heap_arena_kb,heap_in_use_kb,fragmentation,"
+           "live_allocations,actors,level,games,levels_finished\n";
+
+    HeuristicBot bot;
+    seedRandInt(options.seed);
+
+    unique_ptr<ActorWorld> world;
+    int games = 0;
+    int levelsFinished = 0;
+    int levelsAbandoned = 0;
+    long long levelTicks = 0;
+    vector<long long> betweenLevels;
+    map<int, LevelThroughput> byLevel;
+
+      // The bot seldom gets far from level 1, so games start on each of the
+      // first few levels in turn
+    auto newGame = [&]() {
+        if (world)
+        {
+            world->cleanUp();
+            betweenLevels.push_back(liveAllocations());
+        }
+        world.reset(new ActorWorld(""));
+        world->reportMemoryTo(nullptr);
+        world->watchdog().configure(0, 1);
+        world->setInputPolicy(&bot);
+        for (int level = 1; level <= games % options.levels; level++)
+            world->advanceToNextLevel();
+        world->init();
+        games++;
+    };
+    newGame();
+
+      // What the renderer would be handed each tick
+    vector<SpriteSnapshot> sprites;
+
+    vector<SoakSample> samples;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::steady_clock::time_point intervalStart = start;
+    long long quarter = options.ticks / 4;
+    for (long long tick = 1; tick <= options.ticks; tick++)
+    {
+        int level = world->getLevel();
+        chrono::steady_clock::time_point tickStart = chrono::steady_clock::now();
+        GraphObject::beginTick();
+        int status = world->move();
+        world->flushSounds();
+        GraphObject::snapshotAllObjects(sprites);
+        if (tick <= quarter  ||  tick > options.ticks - quarter)
+        {
+            LevelThroughput& t = byLevel[level];
+            int part = (tick <= quarter ? 0 : 1);
+            t.ticks[part]++;
+            t.seconds[part] += chrono::duration<double>(chrono::steady_clock::now() - tickStart).count();
+        }
+
+          // The same transitions GameController makes, without its prompts:
+          // a finished level or a lost life go through cleanUp and init;
+          // game over starts afresh
+        RunOutcome outcome = world->endRun(status);
+        if (outcome == RUN_FINISHED_LEVEL)
+            levelsFinished++;
+
+          // Now and then the last bacteria end up where no spray can reach
+          // (stuck on dirt in the middle of the dish); such a level is
+          // played again rather than idled through for the rest of the run
+        bool stuck = (outcome == RUN_CONTINUES  &&  ++levelTicks >= options.maxLevelTicks);
+        if (stuck)
+            levelsAbandoned++;
+        if (outcome == RUN_GAME_OVER)
+            newGame();
+        else if (outcome != RUN_CONTINUES  ||  stuck)
+        {
+            world->cleanUp();
+            betweenLevels.push_back(liveAllocations());
+            world->init();
+        }
+        if (outcome != RUN_CONTINUES  ||  stuck)
+            levelTicks = 0;
+
+        if (tick % options.sampleEvery == 0)
+        {
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            SoakSample s = SoakSample();
+            s.tick = tick;
+            s.seconds = chrono::duration<double>(now - start).count();
+            s.ticksPerSec = options.sampleEvery / chrono::duration<double>(now - intervalStart).count();
+            residentSetBytes(s.rssBytes);
+            heapStats(s.heap);
+            s.liveAllocations = liveAllocations();
+            s.actors = world->actorCount();
+            s.level = world->getLevel();
+            s.games = games;
+            s.levelsFinished = levelsFinished;
+            samples.push_back(s);
+            writeSample(csv, s);
+            printSample(s);
+            intervalStart = chrono::steady_clock::now();   // don't charge the sampling to the next interval
+        }
+    }
+    world->cleanUp();
+
+    cout << games << " games, " << levelsFinished << " levels finished, " << levelsAbandoned
+         << " abandoned, " << betweenLevels.size() << " level changes" << endl;
+    bool ok = judge(samples, betweenLevels, byLevel, options);
+    cout << (ok ? "Soak passed" : "Soak FAILED") << "; samples in " << options.outPath << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#ifndef SOAK_H_
+#define SOAK_H_
+
+  // Kontagion --soak [options] plays a long headless session with the
+  // HeuristicBot at the keys, moving between levels and lives with
+  // GameWorld::endRun as GameController does (cleanUp then init after every
+  // death and finished level, a fresh world after game over).  At intervals
+  // it samples throughput, resident memory, heap fragmentation, live heap
+  // allocations and actor counts, and at the end it fails if memory grew or
+  // throughput decayed beyond the tolerances:
+  //
+  //   --ticks N             ticks to play (default 2000000)
+  //   --sample-every N      ticks between samples (default 20000)
+  //   --max-level-ticks N   ticks after which a level that hasn't ended is
+  //                         played again (default 100000)
+  //   --levels N            new games start on levels 1 to N in turn
+  //                         (default 10)
+  //   --seed N              seeds the game (default 1)
+  //   --max-rss-growth MB   allowed growth in resident memory after the
+  //                         first few samples (default 16)
+  //   --max-leaked N        allowed growth in heap allocations still live
+  //                         between levels, after the first few (default 16)
+  //   --max-slowdown PCT    allowed drop in ticks/s from the first quarter of
+  //                         the run to the last, level for level (default 25)
+  //   --out FILE            CSV of the samples (default kontagion-soak.csv)
+  //
+  // argc and argv cover only the arguments after --soak.  Returns 0 if the
+  // run stayed within tolerance, 1 otherwise.
+
+int runSoak(int argc, char* argv[]);
+
+#endif // SOAK_H_
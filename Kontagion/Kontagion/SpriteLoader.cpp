@@ -0,0 +1,162 @@
+#include "SpriteLoader.h"
+#include "Tracer.h"
+#include <iostream>
+#include <algorithm>
+using namespace std;
+
+static double msSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+SpriteLoader::SpriteLoader()
+ : m_count(0), m_uploaded(0), m_failed(false), m_fromPack(false), m_nextToDecode(0), m_uploadMs(0), m_packOpenMs(0), m_wallMs(0)
+{
+}
+
+SpriteLoader::~SpriteLoader()
+{
+    joinWorkers();
+}
+
+void SpriteLoader::prepare(const SpriteAsset* assets, size_t count)
+{
+    joinWorkers();
+    m_slots.reset(new Slot[count]);
+    m_count = count;
+    m_uploaded = 0;
+    m_failed = false;
+    m_fromPack = false;
+    m_nextToDecode = 0;
+    m_uploadMs = 0;
+    m_packOpenMs = 0;
+    m_wallMs = 0;
+    m_startTime = chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        Slot& slot = m_slots[i];
+        slot.asset = &assets[i];
+        slot.fromPack = false;
+        slot.ok = false;
+        slot.uploaded = false;
+        slot.readMs = 0;
+        slot.decodeMs = 0;
+        slot.ready = false;
+    }
+}
+
+void SpriteLoader::start(const string& assetPath, const SpriteAsset* assets, size_t count)
+{
+    prepare(assets, count);
+    m_assetPath = assetPath;
+    size_t workers = min<size_t>(max(thread::hardware_concurrency(), 1u), count);
+    for (size_t i = 0; i < workers; i++)
+        m_workers.emplace_back(&SpriteLoader::decodeSprites, this);
+}
+
+void SpriteLoader::start(const AssetPack& pack, double packOpenMs, const SpriteAsset* assets, size_t count)
+{
+    prepare(assets, count);
+    m_fromPack = true;
+    m_packOpenMs = packOpenMs;
+
+      // Pack sprites are already decoded, so they are ready immediately
+    for (size_t i = 0; i < count; i++)
+    {
+        Slot& slot = m_slots[i];
+        slot.fromPack = true;
+        slot.ok = pack.findSprite(slot.asset->tgaFileName, slot.packed);
+        slot.ready = true;
+    }
+}
+
+void SpriteLoader::decodeSprites()
+{
+    Tracer::nameThread("sprite decoder");
+    for (;;)
+    {
+        size_t i = m_nextToDecode++;
+        if (i >= m_count)
+            return;
+        Slot& slot = m_slots[i];
+        TRACE_SCOPE("decode sprite");
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        vector<char> contents;
+        bool ok = readAssetFile(m_assetPath + slot.asset->tgaFileName, contents);
+        slot.readMs = msSince(start);
+
+        start = chrono::steady_clock::now();
+        if (ok)
+        {
+            ok = decodeTga(contents.data(), contents.size(), slot.image);
+            if (ok)
+                buildMipChain(slot.image);
+        }
+        slot.decodeMs = msSince(start);
+
+        slot.ok = ok;
+        slot.ready.store(true, memory_order_release);
+    }
+}
+
+bool SpriteLoader::uploadReady(SpriteManager& spriteManager)
+{
+    TRACE_SCOPE("upload sprites");
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < m_count; i++)
+    {
+        Slot& slot = m_slots[i];
+        if (slot.uploaded  ||  !slot.ready.load(memory_order_acquire))
+            continue;
+
+        bool ok = slot.ok;
+        if (ok  &&  slot.fromPack)
+            ok = spriteManager.loadSprite(slot.packed, slot.asset->imageID, slot.asset->frameNum);
+        else if (ok)
+        {
+            ok = spriteManager.loadSprite(slot.image, slot.asset->imageID, slot.asset->frameNum);
+            slot.image.levels.clear();
+            slot.image.levels.shrink_to_fit();
+        }
+        slot.uploaded = true;
+        m_uploaded++;
+        if (!ok)
+        {
+            cout << "Cannot load sprite " << slot.asset->tgaFileName << endl;
+            m_failed = true;
+        }
+    }
+    m_uploadMs += msSince(start);
+
+    if (m_uploaded < m_count)
+        return false;
+    if (m_wallMs == 0)
+        m_wallMs = msSince(m_startTime);
+    joinWorkers();
+    return true;
+}
+
+void SpriteLoader::reportTiming(ostream& out) const
+{
+    double readMs = m_packOpenMs;
+    double decodeMs = 0;
+    for (size_t i = 0; i < m_count; i++)
+    {
+        readMs += m_slots[i].readMs;
+        decodeMs += m_slots[i].decodeMs;
+    }
+    out << "Loaded " << m_count << " sprites in " << m_wallMs << " ms: "
+        << (m_fromPack ? "pack map " : "file read ") << readMs << " ms, decode "
+        << decodeMs << " ms";
+    if (!m_fromPack)
+        out << " (summed over worker threads)";
+    out << ", upload " << m_uploadMs << " ms" << endl;
+}
+
+void SpriteLoader::joinWorkers()
+{
+    for (thread& t : m_workers)
+        t.join();
+    m_workers.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef SPRITELOADER_H_
+#define SPRITELOADER_H_
+
+#include "SpriteManager.h"
+#include "AssetPack.h"
+#include "AssetManifest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <ostream>
+
+  // Gets every sprite onto the GPU without holding up the welcome screen.
+  // Worker threads read and decode the TGAs (or the pack is mapped), and
+  // the GL thread uploads each one as soon as it is ready by calling
+  // uploadReady from its frame callback.
+
+class SpriteLoader
+{
+  public:
+    SpriteLoader();
+    ~SpriteLoader();
+
+    void start(const std::string& assetPath, const SpriteAsset* assets, std::size_t count);
+    void start(const AssetPack& pack, double packOpenMs, const SpriteAsset* assets, std::size_t count);
+
+      // The following should be used by only the GL thread
+
+      // Uploads whatever has finished decoding.  Returns true once every
+      // sprite has been dealt with.
+    bool uploadReady(SpriteManager& spriteManager);
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    void reportTiming(std::ostream& out) const;
+
+    SpriteLoader(const SpriteLoader&) = delete;
+    SpriteLoader& operator=(const SpriteLoader&) = delete;
+
+  private:
+    struct Slot
+    {
+        const SpriteAsset* asset;
+        DecodedImage       image;
+        PackedSprite       packed;
+        bool               fromPack;
+        bool               ok;
+        bool               uploaded;
+        double             readMs;
+        double             decodeMs;
+        std::atomic<bool>  ready;
+    };
+
+    std::unique_ptr<Slot[]>  m_slots;
+    std::size_t              m_count;
+    std::size_t              m_uploaded;
+    bool                     m_failed;
+    bool                     m_fromPack;
+    std::atomic<std::size_t> m_nextToDecode;
+    std::vector<std::thread> m_workers;
+    std::string              m_assetPath;
+    double                   m_uploadMs;
+    double                   m_packOpenMs;
+    std::chrono::steady_clock::time_point m_startTime;
+    double                   m_wallMs;
+
+    void prepare(const SpriteAsset* assets, std::size_t count);
+    void decodeSprites();
+    void joinWorkers();
+};
+
+#endif // SPRITELOADER_H_
@@ -12,11 +12,11 @@
 #endif
 
 #include "GameConstants.h"
-#include <iostream>
-#include <fstream>
+#include "AssetPack.h"
 #include <string>
+#include <vector>
 #include <map>
-#include <memory>
+#include <algorithm>
 #include <cmath>
 
 static const double VISIBLE_MIN_X = -2.39;
@@ -31,97 +31,48 @@ class SpriteManager
 public:
 
     SpriteManager()
-     : m_mipMapped(true)
+     : m_mipMapped(true), m_textureBytes(0)
     {
     }
 
+      // Texture memory handed to GL, mip levels included
+    std::size_t textureBytes() const
+    {
+        return m_textureBytes;
+    }
+
     bool loadSprite(std::string filename_tga, int imageID, int frameNum)
     {
           // Load Texture Data From TGA File
 
-        int spriteID = getSpriteID(imageID, frameNum);
-        if (spriteID == INVALID_SPRITE_ID)
-            return false;
-
-        m_frameCountPerSprite[imageID]++;   // keep track of how many frames per sprite we loaded
-
-        std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-        if (!tgaFile)
-            return false;
-
-        char type[3];
-        char info[6];
-
-          // Read file header info
-        tgaFile.read(type, 3);
-        tgaFile.seekg(12);
-        tgaFile.read(info, 6);
-        unsigned int textureWidth = static_cast<unsigned char>(info[0]) + static_cast<unsigned char>(info[1]) * 256;
-        unsigned int textureHeight = static_cast<unsigned char>(info[2]) + static_cast<unsigned char>(info[3]) * 256;
-        unsigned char byteCount = static_cast<unsigned char>(info[4]) / 8;
-        long imageSize = textureWidth * textureHeight * byteCount;
-        std::unique_ptr<char[]> imageData(new char[imageSize]);
-        tgaFile.seekg(18);
-          // Read image data
-        tgaFile.read(imageData.get(), imageSize);
-        if (!tgaFile)
+        std::vector<char> contents;
+        DecodedImage image;
+        if (!readAssetFile(filename_tga, contents)  ||
+            !decodeTga(contents.data(), contents.size(), image))
             return false;
 
-          //image type either 2 (color) or 3 (greyscale)
-        if (type[1] != 0 || (type[2] != 2 && type[2] != 3))
-            return false;
-
-        if (byteCount != 3 && byteCount != 4)
-            return false;
-
-          // Transfer Texture To OpenGL
-
-        glEnable(GL_DEPTH_TEST);
-
-          // allocate a texture handle
-        GLuint glTextureID;
-        glGenTextures(1, &glTextureID);
-
-          // bind our new texture
-        glBindTexture(GL_TEXTURE_2D, glTextureID);
-
-        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-
-        if (m_mipMapped)
-        {
-              // when texture area is small, bilinear filter the closest mipmap
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-              // when texture area is large, bilinear filter the first mipmap
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        }
-        else
-        {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        }
-
-          // Have the texture wrap both vertically and horizontally.
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
-
         if (m_mipMapped)
-        {
-              // build our texture mipmaps
-              // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            makeMipmaps(byteCount, textureWidth, textureHeight, imageData.get());
-        }
-        else
-        {
-              // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            if (3 == byteCount)
-                glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData.get());
-            else if (4 == byteCount)
-                glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData.get());
-        }
+            buildMipChain(image);
+        return loadSprite(image, imageID, frameNum);
+    }
 
-        m_imageMap[spriteID] = glTextureID;
+      // Load a sprite that has already been decoded (and possibly mipmapped)
+    bool loadSprite(const DecodedImage& image, int imageID, int frameNum)
+    {
+        const unsigned char* levels[MAX_MIP_LEVELS];
+        for (size_t level = 0; level < image.levels.size(); level++)
+            levels[level] = image.levels[level].data();
+        unsigned int levelCount = static_cast<unsigned int>(image.levels.size());
+        return uploadSprite(imageID, frameNum, image.width, image.height,
+                            m_mipMapped ? levelCount : 1, levels);
+    }
 
-        return true;
+      // Load a sprite that was decoded and mipmapped offline; GL copies the
+      // pixels straight out of the pack.
+    bool loadSprite(const PackedSprite& sprite, int imageID, int frameNum)
+    {
+        return uploadSprite(imageID, frameNum, sprite.width, sprite.height,
+                            m_mipMapped ? sprite.levelCount : 1, sprite.levels);
     }
 
     int getNumFrames(int imageID) const
@@ -228,11 +179,67 @@ private:
     std::map<int, GLuint>   m_imageMap;
     std::map<int, int>      m_frameCountPerSprite;
     bool                    m_mipMapped;
+    std::size_t             m_textureBytes;
 
     static const int INVALID_SPRITE_ID = -1;
     static const int MAX_IMAGES = 1000;
     static const int MAX_FRAMES_PER_SPRITE = 100;
 
+    bool uploadSprite(int imageID, int frameNum, unsigned int textureWidth, unsigned int textureHeight,
+                      unsigned int levelCount, const unsigned char* const* levels)
+    {
+        int spriteID = getSpriteID(imageID, frameNum);
+        if (spriteID == INVALID_SPRITE_ID)
+            return false;
+
+        m_frameCountPerSprite[imageID]++;   // keep track of how many frames per sprite we loaded
+
+          // Transfer Texture To OpenGL
+
+        glEnable(GL_DEPTH_TEST);
+
+          // allocate a texture handle
+        GLuint glTextureID;
+        glGenTextures(1, &glTextureID);
+
+          // bind our new texture
+        glBindTexture(GL_TEXTURE_2D, glTextureID);
+
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        if (m_mipMapped)
+        {
+              // when texture area is small, bilinear filter the closest mipmap
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+              // when texture area is large, bilinear filter the first mipmap
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        else
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+
+          // Have the texture wrap both vertically and horizontally.
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
+
+          // The mip chain was already built on the CPU (or offline), so each
+          // level is a plain RGBA upload.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (unsigned int level = 0; level < levelCount; level++)
+        {
+            GLsizei w = std::max(textureWidth >> level, 1u);
+            GLsizei h = std::max(textureHeight >> level, 1u);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[level]);
+            m_textureBytes += static_cast<std::size_t>(w) * h * 4;
+        }
+
+        m_imageMap[spriteID] = glTextureID;
+
+        return true;
+    }
+
     static int getSpriteID(int imageID, int frame)
     {
         if (imageID >= MAX_IMAGES || frame >= MAX_FRAMES_PER_SPRITE)
@@ -257,18 +264,6 @@ private:
         gy = 2 * VISIBLE_MIN_Y +      y * 2 * (VISIBLE_MAX_Y - VISIBLE_MIN_Y);
         gz = .6 * VISIBLE_MIN_Z;
     }
-
-    static void makeMipmaps(unsigned char byteCount, unsigned int textureWidth, unsigned int textureHeight, char* imageData)
-    {
-        int format = (byteCount == 3 ? GL_BGR : GL_BGRA);
-#ifdef __APPLE__
-        int internalFormat = (byteCount == 3 ? GL_RGB : GL_RGBA);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, textureWidth, textureHeight, 0, format, GL_UNSIGNED_BYTE, imageData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-#else
-        gluBuild2DMipmaps(GL_TEXTURE_2D, byteCount, textureWidth, textureHeight, format, GL_UNSIGNED_BYTE, imageData);
-#endif
-    }
 };
 
 #endif // SPRITEMANAGER_H_
@@ -0,0 +1,64 @@
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <atomic>
+#include <cstddef>
+
+  // Fixed-capacity lock-free ring buffer for exactly one producer thread and
+  // one consumer thread.  Neither push nor pop ever blocks or allocates; a
+  // push into a full ring fails and leaves the ring untouched.  Capacity must
+  // be a power of two.
+
+template<typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2  &&  (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+  public:
+    SpscRing()
+     : m_head(0), m_tail(0)
+    {
+    }
+
+      // The following should be used by only the producer
+
+    bool push(const T& item)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+      // The following should be used by only the consumer
+
+    bool pop(T& item)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        item = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+  private:
+      // Keep the two indices on separate cache lines so the producer and
+      // consumer don't keep stealing each other's line.
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+    T m_items[Capacity];
+};
+
+#endif // SPSCRING_H_
@@ -0,0 +1,297 @@
+#include "StateHash.h"
+#include "ActorWorld.h"
+#include "Actor.h"
+#include <iostream>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+using namespace std;
+
+namespace {
+
+const char STATE_HASH_MAGIC[4] = { 'K', 'T', 'S', 'H' };
+const int STATE_HASH_VERSION = 2;
+
+uint64_t zigzag(long long value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+long long unzigzag(uint64_t value)
+{
+    return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+}
+
+  // One stream of --hash-diff's, read a tick at a time into the state it
+  // describes
+class StateHashReader
+{
+  public:
+    struct ActorEntry
+    {
+        int      type;
+        uint32_t hash;
+    };
+
+    long long            tick = 0;
+    uint64_t             hash = 0;
+    int                  score = 0;
+    int                  level = 0;
+    int                  lives = 0;
+    map<unsigned int, ActorEntry> actors;
+
+    bool open(const string& path)
+    {
+        m_in.open(path, ios::binary);
+        char header[sizeof(STATE_HASH_MAGIC) + 1];
+        if (!m_in.read(header, sizeof(header))  ||  !equal(begin(STATE_HASH_MAGIC), end(STATE_HASH_MAGIC), header))
+        {
+            cout << "Cannot read state hashes from " << path << endl;
+            return false;
+        }
+        if (header[sizeof(STATE_HASH_MAGIC)] != STATE_HASH_VERSION)
+        {
+            cout << path << " has version " << int(header[sizeof(STATE_HASH_MAGIC)])
+                 << " state hashes; this build reads version " << STATE_HASH_VERSION << endl;
+            return false;
+        }
+        return true;
+    }
+
+      // False at the end of the stream, or where a run that was cut short
+      // stopped writing it
+    bool nextTick()
+    {
+        uint64_t value, count;
+        if (!readVarint(value))
+            return false;
+        tick = static_cast<long long>(value);
+        hash = 0;
+        for (int i = 0; i < 8; i++)
+            hash |= static_cast<uint64_t>(static_cast<unsigned char>(m_in.get())) << (8 * i);
+        if (!readVarint(value))
+            return false;
+        score = static_cast<int>(unzigzag(value));
+        if (!readVarint(value))
+            return false;
+        level = static_cast<int>(value);
+        if (!readVarint(value))
+            return false;
+        lives = static_cast<int>(value);
+
+        if (!readVarint(count))
+            return false;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t id, type;
+            if (!readVarint(id)  ||  !readVarint(type))
+                return false;
+            uint32_t actorHash = 0;
+            for (int b = 0; b < 4; b++)
+                actorHash |= static_cast<uint32_t>(static_cast<unsigned char>(m_in.get())) << (8 * b);
+            actors[static_cast<unsigned int>(id)] = ActorEntry{ static_cast<int>(type), actorHash };
+        }
+        if (!readVarint(count))
+            return false;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t id;
+            if (!readVarint(id))
+                return false;
+            actors.erase(static_cast<unsigned int>(id));
+        }
+        return static_cast<bool>(m_in);
+    }
+
+  private:
+    ifstream m_in;
+
+    bool readVarint(uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int byte = m_in.get();
+            if (byte == EOF)
+                return false;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+const char* typeName(int type)
+{
+    return (type >= 0  &&  type < NUM_ACTOR_TYPES ? actorTypeName(static_cast<ActorType>(type)) : "unknown");
+}
+
+  // Says which actor, by id, is the first to differ between the two states
+void reportActorDivergence(const StateHashReader& a, const StateHashReader& b)
+{
+    auto ia = a.actors.begin();
+    auto ib = b.actors.begin();
+    while (ia != a.actors.end()  ||  ib != b.actors.end())
+    {
+        if (ib == b.actors.end()  ||  (ia != a.actors.end()  &&  ia->first < ib->first))
+        {
+            cout << "  actor " << ia->first << " (" << typeName(ia->second.type) << ") is only in the first run" << endl;
+            return;
+        }
+        if (ia == a.actors.end()  ||  ib->first < ia->first)
+        {
+            cout << "  actor " << ib->first << " (" << typeName(ib->second.type) << ") is only in the second run" << endl;
+            return;
+        }
+        if (ia->second.type != ib->second.type  ||  ia->second.hash != ib->second.hash)
+        {
+            cout << "  actor " << ia->first << " (" << typeName(ia->second.type);
+            if (ib->second.type != ia->second.type)
+                cout << " / " << typeName(ib->second.type);
+            cout << ") differs" << endl;
+            return;
+        }
+        ++ia;
+        ++ib;
+    }
+    cout << "  every actor matches, so the difference is in the world's counts or its random sequence" << endl;
+}
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////
+// StateHashWriter
+/////////////////////////////////////////////////////////////////
+
+bool StateHashWriter::open(const string& path)
+{
+    m_out.open(path, ios::binary | ios::trunc);
+    if (!m_out)
+        return false;
+    m_out.write(STATE_HASH_MAGIC, sizeof(STATE_HASH_MAGIC));
+    m_out.put(static_cast<char>(STATE_HASH_VERSION));
+    m_previous.clear();
+    return static_cast<bool>(m_out);
+}
+
+void StateHashWriter::collect(const Actor* actor, void* context)
+{
+    StateHashWriter& writer = *static_cast<StateHashWriter*>(context);
+    writer.m_current.push_back(Entry{ actor->getId(), actor->getType(), static_cast<uint32_t>(actor->stateHash()) });
+}
+
+void StateHashWriter::writeTick(const ActorWorld& world)
+{
+    if (!m_out.is_open())
+        return;
+
+    m_current.clear();
+    if (world.getSocrates() != nullptr)
+        collect(world.getSocrates(), this);
+    world.visitActors(collect, this);
+    sort(m_current.begin(), m_current.end(), [](const Entry& a, const Entry& b) { return a.id < b.id; });
+
+    uint64_t hash = world.stateHash();
+    writeVarint(static_cast<uint64_t>(world.ticks()));
+    for (int i = 0; i < 8; i++)
+        m_out.put(static_cast<char>((hash >> (8 * i)) & 0xff));
+    writeVarint(zigzag(world.getScore()));
+    writeVarint(static_cast<uint64_t>(world.getLevel()));
+    writeVarint(static_cast<uint64_t>(world.getLives()));
+
+      // Both lists are in order of id, so one pass over them finds what is
+      // new or changed, and another what is gone
+    m_changed.clear();
+    size_t p = 0;
+    for (const Entry& e : m_current)
+    {
+        while (p < m_previous.size()  &&  m_previous[p].id < e.id)
+            p++;
+        if (p == m_previous.size()  ||  m_previous[p].id != e.id  ||
+            m_previous[p].type != e.type  ||  m_previous[p].hash != e.hash)
+            m_changed.push_back(e);
+    }
+    m_gone.clear();
+    size_t c = 0;
+    for (const Entry& e : m_previous)
+    {
+        while (c < m_current.size()  &&  m_current[c].id < e.id)
+            c++;
+        if (c == m_current.size()  ||  m_current[c].id != e.id)
+            m_gone.push_back(e.id);
+    }
+
+    writeVarint(m_changed.size());
+    for (const Entry& e : m_changed)
+    {
+        writeVarint(e.id);
+        writeVarint(static_cast<uint64_t>(e.type));
+        for (int i = 0; i < 4; i++)
+            m_out.put(static_cast<char>((e.hash >> (8 * i)) & 0xff));
+    }
+    writeVarint(m_gone.size());
+    for (unsigned int id : m_gone)
+        writeVarint(id);
+    m_previous.swap(m_current);
+}
+
+void StateHashWriter::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    m_out.put(static_cast<char>(value));
+}
+
+/////////////////////////////////////////////////////////////////
+// Comparison
+/////////////////////////////////////////////////////////////////
+
+int compareStateHashes(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        cout << "Usage: Kontagion --hash-diff FIRST SECOND" << endl;
+        return 1;
+    }
+    StateHashReader a, b;
+    if (!a.open(argv[0])  ||  !b.open(argv[1]))
+        return 1;
+
+    long long ticks = 0;
+    for (;;)
+    {
+        bool moreA = a.nextTick();
+        bool moreB = b.nextTick();
+        if (!moreA  ||  !moreB)
+        {
+            if (moreA == moreB)
+            {
+                cout << "The runs agree on all " << ticks << " ticks" << endl;
+                return 0;
+            }
+            cout << "The " << (moreA ? "second" : "first") << " run stops after tick " << ticks
+                 << "; the other goes on" << endl;
+            return 1;
+        }
+        if (a.tick != b.tick)
+        {
+            cout << "The runs are out of step after tick " << ticks << ": the first is at tick " << a.tick
+                 << ", the second at " << b.tick << endl;
+            return 1;
+        }
+        ticks = a.tick;
+        if (a.hash == b.hash)
+            continue;
+
+        cout << "The runs first differ at tick " << a.tick << endl;
+        if (a.score != b.score  ||  a.level != b.level  ||  a.lives != b.lives)
+            cout << "  score " << a.score << " / " << b.score << ", level " << a.level << " / " << b.level
+                 << ", lives " << a.lives << " / " << b.lives << endl;
+        reportActorDivergence(a, b);
+        return 1;
+    }
+}
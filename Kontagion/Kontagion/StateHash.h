@@ -0,0 +1,121 @@
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+
+  // Folds values into a 64-bit hash, for telling whether two runs of the
+  // game are in exactly the same state.  Doubles are hashed by their bits,
+  // so a change in arithmetic that moves an actor by the last bit of its
+  // position shows up.
+
+class StateHasher
+{
+  public:
+    StateHasher()
+     : m_hash(0x9e3779b97f4a7c15ull)
+    {}
+
+    void add(uint64_t value)
+    {
+        m_hash = mix(m_hash ^ value) + 0x9e3779b97f4a7c15ull;
+    }
+
+    void add(long long value)
+    {
+        add(static_cast<uint64_t>(value));
+    }
+
+    void add(int value)
+    {
+        add(static_cast<uint64_t>(static_cast<int64_t>(value)));
+    }
+
+    void add(unsigned int value)
+    {
+        add(static_cast<uint64_t>(value));
+    }
+
+    void add(bool value)
+    {
+        add(static_cast<uint64_t>(value ? 1 : 0));
+    }
+
+    void add(double value)
+    {
+        if (value == 0)
+            value = 0;      // -0 and +0 behave the same
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        add(bits);
+    }
+
+    uint64_t value() const
+    {
+        return mix(m_hash);
+    }
+
+      // The splitmix64 finalizer: every bit of the input affects every bit
+      // of the output
+    static uint64_t mix(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+  private:
+    uint64_t m_hash;
+};
+
+class ActorWorld;
+class Actor;
+
+  // Writes a world's state hash after every tick, with the hashes of the
+  // actors that changed, to a file that --hash-diff compares with one from
+  // another run (another build, say) of the same replay.
+  //
+  // After "KTSH" and a version byte, each tick is the tick number, the
+  // world's hash (8 bytes, little-endian), its score (zigzag), level and
+  // lives, then how many actors are new or changed and, for each, its id,
+  // type and the low 32 bits of its hash, then how many actors are gone
+  // and their ids.  Numbers other than hashes are LEB128 varints.  Dirt,
+  // food and pits that sit still aren't written again, so a tick is
+  // usually well under a hundred bytes.
+
+class StateHashWriter
+{
+  public:
+    bool open(const std::string& path);
+    void writeTick(const ActorWorld& world);
+
+  private:
+    struct Entry
+    {
+        unsigned int id;
+        int          type;
+        uint32_t     hash;
+    };
+
+    std::ofstream      m_out;
+    std::vector<Entry> m_previous;      // last tick's actors, by id
+    std::vector<Entry> m_current;
+    std::vector<Entry> m_changed;
+    std::vector<unsigned int> m_gone;
+
+    static void collect(const Actor* actor, void* context);
+    void writeVarint(uint64_t value);
+};
+
+  // Kontagion --hash-diff A B compares two streams written by
+  // Kontagion --replay FILE --hashes A (and --hashes B) and reports the
+  // first tick on which the worlds' states differ, and the first actor, by
+  // id, that differs there.  argc and argv cover only the arguments after
+  // --hash-diff.  Returns 0 if the streams agree, 1 otherwise.
+
+int compareStateHashes(int argc, char* argv[]);
+
+#endif // STATEHASH_H_
@@ -0,0 +1,44 @@
+#include "TickProfile.h"
+using namespace std;
+
+static const char* const PHASE_NAMES[NUM_TICK_PHASES] = {
+    "input", "actors", "events", "cleanup", "spawn", "status"
+};
+
+const char* tickPhaseName(TickPhase phase)
+{
+    return PHASE_NAMES[phase];
+}
+
+long long TickProfile::totalNs() const
+{
+    long long total = 0;
+    for (const PhaseTiming& p : phases)
+        total += p.ns;
+    return total;
+}
+
+void TickProfile::print(ostream& out) const
+{
+    out << "tick " << tick << ":";
+    for (int i = 0; i < NUM_TICK_PHASES; i++)
+        out << ' ' << PHASE_NAMES[i] << ' ' << phases[i].ns / 1000.0 << "us ("
+            << phases[i].items << ')';
+    out << " total " << totalNs() / 1000.0 << "us" << endl;
+}
+
+void TickProfile::writeCsvHeader(ostream& out)
+{
+    out << "tick";
+    for (int i = 0; i < NUM_TICK_PHASES; i++)
+        out << ',' << PHASE_NAMES[i] << "_ns," << PHASE_NAMES[i] << "_items";
+    out << '\n';
+}
+
+void TickProfile::writeCsv(ostream& out) const
+{
+    out << tick;
+    for (int i = 0; i < NUM_TICK_PHASES; i++)
+        out << ',' << phases[i].ns << ',' << phases[i].items;
+    out << '\n';
+}
@@ -0,0 +1,112 @@
+#ifndef TICKPROFILE_H_
+#define TICKPROFILE_H_
+
+#include "Tracer.h"
+#include <chrono>
+#include <ostream>
+
+  // The phases of a world tick, in the order they run
+enum TickPhase
+{
+    PHASE_INPUT,        // Socrates reads the keyboard and acts
+    PHASE_ACTORS,       // every other actor moves, fights and eats
+    PHASE_EVENTS,       // side effects queued by the actors are applied
+    PHASE_CLEANUP,      // dead actors are removed
+    PHASE_SPAWN,        // goodies and fungi may appear
+    PHASE_STATUS,       // the status line is rebuilt
+    NUM_TICK_PHASES
+};
+
+const char* tickPhaseName(TickPhase phase);
+
+struct PhaseTiming
+{
+    long long ns;       // time spent in the phase
+    int       items;    // actors updated, events applied, etc.
+};
+
+  // What one tick spent in each phase.  Phases a tick never reached (because
+  // Socrates died or the level ended) are left at zero.
+struct TickProfile
+{
+    unsigned long tick;
+    PhaseTiming   phases[NUM_TICK_PHASES];
+
+    long long totalNs() const;
+
+      // One line: "tick 1234: input 2.1us (1) actors 45.0us (212) ..."
+    void print(std::ostream& out) const;
+
+      // A CSV row: tick, then ns and items for each phase
+    static void writeCsvHeader(std::ostream& out);
+    void writeCsv(std::ostream& out) const;
+};
+
+  // Called at each phase boundary: with -1 as a tick begins, then with each
+  // phase as it ends.  Lets tools such as the benchmark's hardware counters
+  // attribute their own measurements to phases.
+typedef void (*TickPhaseObserver)(int endedPhase, void* context);
+
+  // Times the phases of the current tick as the world runs them
+class TickProfiler
+{
+  public:
+    TickProfiler()
+     : m_current(), m_last(), m_ticks(0), m_observer(nullptr), m_observerContext(nullptr)
+    {
+    }
+
+    void setObserver(TickPhaseObserver observer, void* context)
+    {
+        m_observer = observer;
+        m_observerContext = context;
+    }
+
+    void beginTick()
+    {
+        m_current = TickProfile();
+        m_current.tick = ++m_ticks;
+        if (m_observer != nullptr)
+            m_observer(-1, m_observerContext);
+        m_phaseStart = std::chrono::steady_clock::now();
+    }
+
+      // Close the phase that started when the previous phase ended (or when
+      // the tick began), and show it in the trace if one is being recorded
+    void endPhase(TickPhase phase, int items)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        PhaseTiming& timing = m_current.phases[phase];
+        timing.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_phaseStart).count();
+        timing.items += items;
+        if (Tracer::enabled())
+            Tracer::complete(tickPhaseName(phase), m_phaseStart, now);
+        m_phaseStart = now;
+        if (m_observer != nullptr)
+        {
+            m_observer(phase, m_observerContext);
+            m_phaseStart = std::chrono::steady_clock::now();   // don't charge the observer to the next phase
+        }
+    }
+
+    void endTick()
+    {
+        m_last = m_current;
+    }
+
+      // The breakdown of the most recently finished tick
+    const TickProfile& lastTick() const
+    {
+        return m_last;
+    }
+
+  private:
+    TickProfile   m_current;
+    TickProfile   m_last;
+    unsigned long m_ticks;
+    TickPhaseObserver m_observer;
+    void*         m_observerContext;
+    std::chrono::steady_clock::time_point m_phaseStart;
+};
+
+#endif // TICKPROFILE_H_
@@ -0,0 +1,81 @@
+#include "TickWatchdog.h"
+#include <cstdlib>
+#include <algorithm>
+using namespace std;
+
+static const double DEFAULT_BUDGET_MS = 5;
+static const int DEFAULT_HISTORY = 32;
+
+TickWatchdog::TickWatchdog()
+ : m_next(0), m_filled(0), m_budgetNs(0), m_ticks(0), m_quietUntil(0), m_suppressed(0), m_suppressedBefore(0)
+{
+    const char* budget = getenv("KONTAGION_TICK_BUDGET_MS");
+    const char* history = getenv("KONTAGION_WATCHDOG_TICKS");
+    configure(budget != nullptr ? atof(budget) : DEFAULT_BUDGET_MS,
+              history != nullptr ? atoi(history) : DEFAULT_HISTORY);
+}
+
+void TickWatchdog::configure(double budgetMs, int history)
+{
+    m_budgetNs = static_cast<long long>(max(budgetMs, 0.0) * 1e6);
+    m_history.assign(max(history, 1), WatchdogSample());
+    m_next = 0;
+    m_filled = 0;
+    m_quietUntil = 0;
+    m_suppressed = 0;
+    m_suppressedBefore = 0;
+}
+
+double TickWatchdog::budgetMs() const
+{
+    return m_budgetNs / 1e6;
+}
+
+bool TickWatchdog::record(const TickProfile& profile, const int population[NUM_ACTOR_TYPES])
+{
+    if (m_budgetNs == 0)
+        return false;
+
+    WatchdogSample& sample = m_history[m_next];
+    sample.profile = profile;
+    copy(population, population + NUM_ACTOR_TYPES, sample.population);
+    m_next = (m_next + 1) % m_history.size();
+    m_filled = min(m_filled + 1, m_history.size());
+    m_ticks++;
+
+    if (profile.totalNs() <= m_budgetNs)
+        return false;
+    if (m_ticks < m_quietUntil)
+    {
+        m_suppressed++;
+        return false;
+    }
+    m_quietUntil = m_ticks + m_history.size();
+    m_suppressedBefore = m_suppressed;
+    m_suppressed = 0;
+    return true;
+}
+
+void TickWatchdog::dump(ostream& out, int level, int bacteria, int projectiles) const
+{
+    const WatchdogSample& slow = m_history[(m_next + m_history.size() - 1) % m_history.size()];
+    out << "Slow tick " << slow.profile.tick << ": " << slow.profile.totalNs() / 1e6 << " ms against a "
+        << budgetMs() << " ms budget; level " << level << ", " << bacteria << " bacteria, "
+        << projectiles << " projectiles in flight";
+    if (m_suppressedBefore > 0)
+        out << " (" << m_suppressedBefore << " earlier overruns not shown)";
+    out << "\nThe last " << m_filled << " ticks:\n";
+
+    for (size_t i = 0; i < m_filled; i++)
+    {
+        const WatchdogSample& s = m_history[(m_next + m_history.size() - m_filled + i) % m_history.size()];
+        out << "  ";
+        s.profile.print(out);
+        out << "    ";
+        for (int t = 0; t < NUM_ACTOR_TYPES; t++)
+            if (s.population[t] > 0)
+                out << ' ' << actorTypeName(static_cast<ActorType>(t)) << ' ' << s.population[t];
+        out << '\n';
+    }
+    out.flush();
+}
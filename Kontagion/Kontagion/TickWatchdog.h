@@ -0,0 +1,50 @@
+#ifndef TICKWATCHDOG_H_
+#define TICKWATCHDOG_H_
+
+#include "TickProfile.h"
+#include "Actor.h"
+#include <ostream>
+#include <vector>
+
+  // What the world looked like during one tick
+struct WatchdogSample
+{
+    TickProfile profile;
+    int         population[NUM_ACTOR_TYPES];    // live actors of each type as the tick ran
+};
+
+  // Remembers the last few ticks so that when one runs over budget there is
+  // something to explain it: which phase grew, and what the dish was full of
+  // on the way there.
+  //
+  // The budget and history length come from KONTAGION_TICK_BUDGET_MS
+  // (default 5; 0 turns the watchdog off) and KONTAGION_WATCHDOG_TICKS
+  // (default 32), and can be changed with configure().
+class TickWatchdog
+{
+  public:
+    TickWatchdog();
+
+    void configure(double budgetMs, int history);
+    double budgetMs() const;
+
+      // Note a finished tick.  Returns true if it overran the budget and the
+      // history should be dumped; after that, further overruns are only
+      // counted until a full new history has been gathered.
+    bool record(const TickProfile& profile, const int population[NUM_ACTOR_TYPES]);
+
+      // The slow tick, the world's state now, then the history, oldest first
+    void dump(std::ostream& out, int level, int bacteria, int projectiles) const;
+
+  private:
+    std::vector<WatchdogSample> m_history;
+    size_t        m_next;               // slot the next tick goes in
+    size_t        m_filled;
+    long long     m_budgetNs;
+    unsigned long m_ticks;
+    unsigned long m_quietUntil;         // no dumps before this tick
+    int           m_suppressed;         // overruns not dumped since the last dump
+    int           m_suppressedBefore;   // ... as of the dump being reported
+};
+
+#endif // TICKWATCHDOG_H_
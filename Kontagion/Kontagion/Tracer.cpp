@@ -0,0 +1,281 @@
+#include "Tracer.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+using namespace std;
+
+atomic<bool> Tracer::s_enabled(false);
+
+namespace {
+
+struct TraceEvent
+{
+    const char* name;
+    long long   beginNs;    // since the trace started
+    long long   durationNs;
+    char        phase;      // 'X' for a span, 'i' for an instant
+};
+
+const size_t EVENTS_PER_CHUNK = 4096;
+
+struct TraceChunk
+{
+    TraceChunk* next;
+    size_t      count;
+    TraceEvent  events[EVENTS_PER_CHUNK];
+};
+
+  // One per thread that has recorded anything.  Only the owning thread
+  // touches current; full chunks are pushed onto a stack the writer thread
+  // takes whole, so neither side ever waits for the other.
+struct ThreadBuffer
+{
+    int                      tid;
+    const char*              name;
+    TraceChunk*              current;
+    atomic<TraceChunk*>      full;
+};
+
+struct TraceState
+{
+    mutex                            registryLock;
+    vector<unique_ptr<ThreadBuffer>> threads;
+    int                              nextTid = 1;
+
+    ofstream                         out;
+    bool                             anyWritten = false;
+    Tracer::TimePoint                origin;
+    Tracer::TimePoint                deadline;
+    bool                             hasDeadline = false;
+    bool                             started = false;
+
+    thread                           writer;
+    mutex                            wakeLock;
+    condition_variable               wake;
+    bool                             stopping = false;
+};
+
+TraceState& state()
+{
+    static TraceState s;
+    return s;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer* threadBuffer()
+{
+    if (t_buffer == nullptr)
+    {
+        TraceState& s = state();
+        unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+        buffer->name = nullptr;
+        buffer->current = nullptr;
+        buffer->full = nullptr;
+        lock_guard<mutex> lock(s.registryLock);
+        buffer->tid = s.nextTid++;
+        t_buffer = buffer.get();
+        s.threads.push_back(move(buffer));
+    }
+    return t_buffer;
+}
+
+void record(const TraceEvent& event)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    TraceChunk* chunk = buffer->current;
+    if (chunk == nullptr  ||  chunk->count == EVENTS_PER_CHUNK)
+    {
+        if (chunk != nullptr)
+        {
+            chunk->next = buffer->full.load(memory_order_relaxed);
+            while (!buffer->full.compare_exchange_weak(chunk->next, chunk, memory_order_release,
+                                                       memory_order_relaxed))
+                ;
+        }
+        chunk = new TraceChunk;
+        chunk->next = nullptr;
+        chunk->count = 0;
+        buffer->current = chunk;
+    }
+    chunk->events[chunk->count++] = event;
+}
+
+long long nsSinceStart(Tracer::TimePoint t)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(t - state().origin).count();
+}
+
+void writeString(ostream& out, const char* text)
+{
+    out << '"';
+    for (const char* p = text; *p != '\0'; p++)
+    {
+        if (*p == '"'  ||  *p == '\\')
+            out << '\\';
+        out << *p;
+    }
+    out << '"';
+}
+
+void beginEntry(TraceState& s)
+{
+    s.out << (s.anyWritten ? ",\n" : "\n");
+    s.anyWritten = true;
+}
+
+void writeChunk(TraceState& s, int tid, const TraceChunk* chunk)
+{
+    for (size_t i = 0; i < chunk->count; i++)
+    {
+        const TraceEvent& e = chunk->events[i];
+        beginEntry(s);
+        s.out << "{\"name\":";
+        writeString(s.out, e.name);
+        s.out << ",\"cat\":\"kontagion\",\"ph\":\"" << e.phase << "\",\"ts\":" << e.beginNs / 1000.0;
+        if (e.phase == 'X')
+            s.out << ",\"dur\":" << e.durationNs / 1000.0;
+        else
+            s.out << ",\"s\":\"t\"";
+        s.out << ",\"pid\":1,\"tid\":" << tid << "}";
+    }
+}
+
+  // Write out and free every chunk the threads have filled so far, oldest
+  // first
+void writeFullChunks(TraceState& s)
+{
+    vector<ThreadBuffer*> buffers;
+    {
+        lock_guard<mutex> lock(s.registryLock);
+        for (const unique_ptr<ThreadBuffer>& b : s.threads)
+            buffers.push_back(b.get());
+    }
+    for (ThreadBuffer* b : buffers)
+    {
+        TraceChunk* newestFirst = b->full.exchange(nullptr, memory_order_acquire);
+        TraceChunk* oldestFirst = nullptr;
+        while (newestFirst != nullptr)
+        {
+            TraceChunk* next = newestFirst->next;
+            newestFirst->next = oldestFirst;
+            oldestFirst = newestFirst;
+            newestFirst = next;
+        }
+        while (oldestFirst != nullptr)
+        {
+            TraceChunk* next = oldestFirst->next;
+            writeChunk(s, b->tid, oldestFirst);
+            delete oldestFirst;
+            oldestFirst = next;
+        }
+    }
+}
+
+}  // namespace
+
+void Tracer::writeInBackground()
+{
+    TraceState& s = state();
+    unique_lock<mutex> lock(s.wakeLock);
+    while (!s.stopping)
+    {
+        s.wake.wait_for(lock, chrono::milliseconds(100));
+        if (s.hasDeadline  &&  Tracer::enabled()  &&  chrono::steady_clock::now() >= s.deadline)
+            s_enabled.store(false, memory_order_relaxed);
+        lock.unlock();
+        writeFullChunks(s);
+        lock.lock();
+    }
+}
+
+bool Tracer::start(const string& path, double seconds)
+{
+    TraceState& s = state();
+    if (s.started)
+        return false;
+    s.out.open(path);
+    if (!s.out)
+    {
+        cout << "Cannot create trace file " << path << endl;
+        return false;
+    }
+    s.started = true;
+    s.out << fixed << setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    s.origin = chrono::steady_clock::now();
+    s.hasDeadline = (seconds > 0);
+    if (s.hasDeadline)
+        s.deadline = s.origin + chrono::duration_cast<chrono::steady_clock::duration>(
+                                    chrono::duration<double>(seconds));
+    s_enabled.store(true, memory_order_relaxed);
+    nameThread("main");
+    s.writer = thread(writeInBackground);
+    return true;
+}
+
+void Tracer::stop()
+{
+    TraceState& s = state();
+    if (!s.started  ||  !s.writer.joinable())
+        return;
+    s_enabled.store(false, memory_order_relaxed);
+    {
+        lock_guard<mutex> lock(s.wakeLock);
+        s.stopping = true;
+    }
+    s.wake.notify_one();
+    s.writer.join();
+
+      // Everything has been handed over now, including the partly filled
+      // chunks the threads were still writing into
+    writeFullChunks(s);
+    for (const unique_ptr<ThreadBuffer>& b : s.threads)
+    {
+        if (b->current != nullptr)
+        {
+            writeChunk(s, b->tid, b->current);
+            delete b->current;
+            b->current = nullptr;
+        }
+        if (b->name != nullptr)
+        {
+            beginEntry(s);
+            s.out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+                  << ",\"args\":{\"name\":";
+            writeString(s.out, b->name);
+            s.out << "}}";
+        }
+    }
+    beginEntry(s);
+    s.out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Kontagion\"}}\n]}\n";
+    s.out.close();
+}
+
+void Tracer::complete(const char* name, TimePoint begin, TimePoint end)
+{
+    if (!enabled())
+        return;
+    long long beginNs = nsSinceStart(begin);
+    TraceEvent event = { name, beginNs, nsSinceStart(end) - beginNs, 'X' };
+    record(event);
+}
+
+void Tracer::instant(const char* name)
+{
+    if (!enabled())
+        return;
+    TraceEvent event = { name, nsSinceStart(chrono::steady_clock::now()), 0, 'i' };
+    record(event);
+}
+
+void Tracer::nameThread(const char* name)
+{
+    if (!enabled())
+        return;
+    threadBuffer()->name = name;
+}
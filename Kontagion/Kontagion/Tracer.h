@@ -0,0 +1,86 @@
+#ifndef TRACER_H_
+#define TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+  // Records what the game's threads spend their time on and writes it in the
+  // Chrome trace-event format, which chrome://tracing and ui.perfetto.dev
+  // open directly.
+  //
+  // Each thread appends to its own buffer of fixed-size chunks, so recording
+  // an event takes no lock.  Full chunks are handed to a background thread
+  // that writes them out; whatever is left in the partly filled chunks is
+  // written by stop().  Event names must be string literals (or otherwise
+  // outlive the trace), since only the pointer is stored.
+
+class Tracer
+{
+  public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+      // Start tracing into path.  If seconds is positive, recording stops on
+      // its own that long after starting (the file is still finished by
+      // stop()).  Returns false if the file can't be created.
+    static bool start(const std::string& path, double seconds = 0);
+
+      // Stop recording and finish the file.  Every thread that recorded
+      // events other than the caller must have finished doing so.
+    static void stop();
+
+    static bool enabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+      // A span that ran from begin to end on the calling thread
+    static void complete(const char* name, TimePoint begin, TimePoint end);
+
+      // A point in time on the calling thread, such as a state change
+    static void instant(const char* name);
+
+      // The name the calling thread is shown under in the viewer
+    static void nameThread(const char* name);
+
+  private:
+    static std::atomic<bool> s_enabled;
+
+    static void writeInBackground();
+};
+
+  // Records the span from its construction to its destruction
+class TraceScope
+{
+  public:
+    explicit TraceScope(const char* name)
+     : m_name(Tracer::enabled() ? name : nullptr)
+    {
+        if (m_name != nullptr)
+            m_begin = std::chrono::steady_clock::now();
+    }
+
+    ~TraceScope()
+    {
+        if (m_name != nullptr)
+            Tracer::complete(m_name, m_begin, std::chrono::steady_clock::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    const char*       m_name;
+    Tracer::TimePoint m_begin;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+  // TRACE_SCOPE("name") traces the rest of the enclosing block
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#define TRACE_INSTANT(name) \
+    do { if (Tracer::enabled()) Tracer::instant(name); } while (false)
+
+#endif // TRACER_H_
@@ -0,0 +1,62 @@
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <atomic>
+
+  // Lock-free single-producer/single-consumer triple buffer.  The producer
+  // fills back() and calls publish(); the consumer calls update() and reads
+  // front().  Each side owns one slot outright and they trade the third
+  // through an atomic index, so neither ever waits for the other.  A consumer
+  // that falls behind only ever sees the most recently published slot.
+
+template<typename T>
+class TripleBuffer
+{
+  public:
+    TripleBuffer()
+     : m_middle(1), m_back(0), m_front(2)
+    {
+    }
+
+      // The following should be used by only the producer
+
+    T& back()
+    {
+        return m_slots[m_back];
+    }
+
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+      // The following should be used by only the consumer
+
+      // Returns true if a newer slot than the current front was published.
+    bool update()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const
+    {
+        return m_slots[m_front];
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  private:
+    static const int FRESH_BIT = 4;
+    static const int INDEX_MASK = 3;
+
+    T                m_slots[3];
+    std::atomic<int> m_middle;
+    int              m_back;
+    int              m_front;
+};
+
+#endif // TRIPLEBUFFER_H_
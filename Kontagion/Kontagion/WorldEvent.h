@@ -0,0 +1,29 @@
+#ifndef WORLDEVENT_H_
+#define WORLDEVENT_H_
+
+    // Side effects that actors request of the world while they update.  They
+    // are queued and applied together once every actor has had its turn.
+enum WorldEventType {
+    EVENT_SCORE,                    // amount: points to add (may be negative)
+    EVENT_DROP_FOOD,                // x, y: where the bacterium died
+    EVENT_BACTERIUM_DIED,
+    EVENT_PIT_EMPTIED,
+    EVENT_HEAL_SOCRATES,
+    EVENT_HURT_SOCRATES,            // amount: damage to deal
+    EVENT_RECHARGE_FLAMETHROWER,
+    EVENT_EXTRA_LIFE
+};
+
+struct WorldEvent {
+    WorldEventType type;
+    int amount;
+    double x, y;
+};
+
+    // Called once per event, after the world has applied it
+typedef void (*WorldEventListener)(const WorldEvent& event, void* context);
+
+const int MAX_WORLD_EVENTS = 256;
+const int MAX_WORLD_EVENT_LISTENERS = 8;
+
+#endif // WORLDEVENT_H_
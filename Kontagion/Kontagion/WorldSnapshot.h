@@ -0,0 +1,38 @@
+#ifndef WORLDSNAPSHOT_H_
+#define WORLDSNAPSHOT_H_
+
+#include "GameConstants.h"
+#include <vector>
+#include <chrono>
+
+  // What the renderer needs to draw one GraphObject.  The simulation thread
+  // captures these after every tick so drawing never touches live actors.
+struct SpriteSnapshot
+{
+    int    imageID;
+    int    frame;       // animation number; the renderer wraps it by frame count
+    float  prevX;       // position at the start of the tick
+    float  prevY;
+    float  x;           // position at the end of the tick
+    float  y;
+    int    angle;
+    float  size;
+    int    depth;
+};
+
+struct WorldSnapshot
+{
+    WorldSnapshot()
+     : tick(0)
+    {
+        sprites.reserve(1024);
+        statusText[0] = '\0';
+    }
+
+    std::vector<SpriteSnapshot>           sprites;    // in drawing order
+    char                                  statusText[MAX_STATUS_TEXT];
+    std::chrono::steady_clock::time_point tickTime;   // when the tick began
+    unsigned long                         tick;
+};
+
+#endif // WORLDSNAPSHOT_H_
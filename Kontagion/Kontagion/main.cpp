@@ -1,7 +1,16 @@
 #include "GameController.h"
+#include "AssetPack.h"
+#include "Benchmark.h"
+#include "BenchCompare.h"
+#include "Soak.h"
+#include "KontagionEnv.h"
+#include "Replay.h"
+#include "StateHash.h"
+#include "Tracer.h"
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstdlib>
 using namespace std;
 
 #ifdef _MSC_VER
@@ -30,8 +39,59 @@ class GameWorld;
 
 GameWorld* createActorWorld(string assetPath = "");
 
+  // Kontagion --trace FILE [--trace-seconds N] ... records a Chrome trace of
+  // the rest of the run (or its first N seconds).  The KONTAGION_TRACE and
+  // KONTAGION_TRACE_SECONDS environment variables do the same.
+static void startTracing(int& argc, char**& argv)
+{
+    const char* path = getenv("KONTAGION_TRACE");
+    const char* seconds = getenv("KONTAGION_TRACE_SECONDS");
+    while (argc >= 3  &&  (string(argv[1]) == "--trace"  ||  string(argv[1]) == "--trace-seconds"))
+    {
+        if (string(argv[1]) == "--trace")
+            path = argv[2];
+        else
+            seconds = argv[2];
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
+    if (path != nullptr  &&  *path != '\0')
+        Tracer::start(path, seconds != nullptr ? atof(seconds) : 0);
+}
+
+static int runTool(int (*tool)(int, char*[]), int argc, char* argv[])
+{
+    int status = tool(argc, argv);
+    Tracer::stop();
+    return status;
+}
+
 int main(int argc, char* argv[])
 {
+    startTracing(argc, argv);
+
+      // Kontagion --bench [options] times the simulation and --bench-compare
+      // checks two runs for regressions, as --verify-zero-alloc checks the
+      // steady-state ticks for heap allocations, --soak plays for hours,
+      // --env-bench times the training environments, --replay plays a
+      // recorded session again and --hash-diff finds where two replays'
+      // states part; none of them need the assets
+    if (argc >= 2  &&  string(argv[1]) == "--bench")
+        return runTool(runBenchmarks, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--bench-compare")
+        return runTool(compareBenchmarks, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--verify-zero-alloc")
+        return runTool(verifyZeroAllocations, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--soak")
+        return runTool(runSoak, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--env-bench")
+        return runTool(runEnvBench, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--replay")
+        return runTool(runReplay, argc - 2, argv + 2);
+    if (argc >= 2  &&  string(argv[1]) == "--hash-diff")
+        return runTool(compareStateHashes, argc - 2, argv + 2);
+
     string assetPath = assetDirectory;
     if (!assetPath.empty())
     {
@@ -42,10 +102,19 @@ int main(int argc, char* argv[])
         }
         assetPath += '/';
     }
+
+      // Kontagion --pack-assets [packFile] bakes the asset directory into a pack
+    if (argc >= 2  &&  string(argv[1]) == "--pack-assets")
+    {
+        string packPath = (argc >= 3 ? argv[2] : assetPath + ASSET_PACK_NAME);
+        return AssetPack::write(assetPath, packPath) ? 0 : 1;
+    }
+
     {
         const string someAsset = "socrates.tga";
+        ifstream pack(assetPath + ASSET_PACK_NAME);
         ifstream ifs(assetPath + someAsset);
-        if (!ifs)
+        if (!pack  &&  !ifs)
         {
             cout << "Cannot find " << someAsset << " in ";
             cout << (assetDirectory.empty() ? "current directory" : assetDirectory) << endl;
@@ -53,6 +122,11 @@ int main(int argc, char* argv[])
         }
     }
 
+      // Kontagion --record FILE records the session for --replay, and
+      // Kontagion --watch FILE [--speed X] plays one back on screen
     GameWorld* gw = createActorWorld(assetPath);
+    if (!prepareSession(argc, argv, gw, Game()))
+        return 1;
     Game().run(argc, argv, gw, "Kontagion");
+    Tracer::stop();
 }